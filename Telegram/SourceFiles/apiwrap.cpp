@@ -43,6 +43,7 @@ constexpr auto kReloadChannelMembersTimeout = 1000; // 1 second wait before relo
 constexpr auto kSaveCloudDraftTimeout = 1000; // save draft to the cloud with 1 sec extra delay
 constexpr auto kSaveDraftBeforeQuitTimeout = 1500; // give the app 1.5 secs to save drafts to cloud when quitting
 constexpr auto kSmallDelayMs = 5;
+constexpr auto kPeersPerRequest = 100;
 constexpr auto kUnreadMentionsPreloadIfLess = 5;
 constexpr auto kUnreadMentionsFirstRequestLimit = 10;
 constexpr auto kUnreadMentionsNextRequestLimit = 100;
@@ -124,6 +125,7 @@ FileLoadTo FileLoadTaskOptions(const ApiWrap::SendOptions &options) {
 ApiWrap::ApiWrap(not_null<AuthSession*> session)
 : _session(session)
 , _messageDataResolveDelayed([this] { resolveMessageDatas(); })
+, _peersResolveDelayed([this] { resolvePeers(); })
 , _webPagesTimer([this] { resolveWebPages(); })
 , _draftsSaveTimer([this] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([this] { readFeaturedSets(); })
@@ -500,83 +502,191 @@ void ApiWrap::gotUserFull(UserData *user, const MTPUserFull &result, mtpRequestI
 void ApiWrap::requestPeer(PeerData *peer) {
 	if (!peer || _fullPeerRequests.contains(peer) || _peerRequests.contains(peer)) return;
 
-	auto sendRequest = [this, peer] {
-		auto failHandler = [this, peer](const RPCError &error) {
-			_peerRequests.remove(peer);
-		};
-		auto chatHandler = [this, peer](const MTPmessages_Chats &result) {
-			_peerRequests.remove(peer);
-
-			if (auto chats = Api::getChatsFromMessagesChats(result)) {
-				auto &v = chats->v;
-				bool badVersion = false;
-				if (auto chat = peer->asChat()) {
-					badVersion = (!v.isEmpty() && v[0].type() == mtpc_chat && v[0].c_chat().vversion.v < chat->version);
-				} else if (auto channel = peer->asChannel()) {
-					badVersion = (!v.isEmpty() && v[0].type() == mtpc_channel && v[0].c_channel().vversion.v < channel->version);
+	// Zero request id means that the peer waits for the next batch.
+	_peerRequests.insert(peer, 0);
+	_peersResolveDelayed.call();
+}
+
+void ApiWrap::requestPeers(const QList<PeerData*> &peers) {
+	for (const auto peer : peers) {
+		requestPeer(peer);
+	}
+}
+
+void ApiWrap::resolvePeers() {
+	auto users = std::vector<not_null<UserData*>>();
+	auto chats = std::vector<not_null<ChatData*>>();
+	auto channels = std::vector<not_null<ChannelData*>>();
+	for (auto i = _peerRequests.cbegin(), e = _peerRequests.cend(); i != e; ++i) {
+		if (i.value()) continue;
+		const auto peer = i.key();
+		if (const auto user = peer->asUser()) {
+			users.push_back(user);
+		} else if (const auto chat = peer->asChat()) {
+			chats.push_back(chat);
+		} else if (const auto channel = peer->asChannel()) {
+			channels.push_back(channel);
+		}
+	}
+
+	auto requestsCount = 0;
+	const auto sendBatches = [&](const auto &list) {
+		for (auto from = list.begin(); from != list.end();) {
+			const auto till = (list.end() - from > kPeersPerRequest)
+				? (from + kPeersPerRequest)
+				: list.end();
+			using List = std::decay_t<decltype(list)>;
+			sendPeersRequest(List(from, till));
+			++requestsCount;
+			from = till;
+		}
+	};
+	sendBatches(users);
+	sendBatches(chats);
+	sendBatches(channels);
+
+	const auto peersCount = int(users.size() + chats.size() + channels.size());
+	if (!peersCount) {
+		return;
+	}
+	_peersRequested += peersCount;
+	_peersRequestsSaved += peersCount - requestsCount;
+	DEBUG_LOG(("API Info: requesting %1 peers in %2 requests, saved %3 of %4 requests in total.").arg(peersCount).arg(requestsCount).arg(_peersRequestsSaved).arg(_peersRequested));
+}
+
+void ApiWrap::sendPeersRequest(const std::vector<not_null<UserData*>> &users) {
+	auto inputs = QVector<MTPInputUser>();
+	inputs.reserve(users.size());
+	for (const auto user : users) {
+		inputs.push_back(user->inputUser);
+	}
+	const auto requestId = request(MTPusers_GetUsers(
+		MTP_vector<MTPInputUser>(inputs)
+	)).done([this](const MTPVector<MTPUser> &result, mtpRequestId requestId) {
+		App::feedUsers(result);
+		finalizePeersRequest(requestId);
+	}).fail([this](const RPCError &error, mtpRequestId requestId) {
+		failPeersRequest(error, requestId);
+	}).priority(MTP::RequestPriority::Background).send();
+	for (const auto user : users) {
+		_peerRequests[user.get()] = requestId;
+	}
+}
+
+void ApiWrap::sendPeersRequest(const std::vector<not_null<ChatData*>> &chats) {
+	auto inputs = QVector<MTPint>();
+	inputs.reserve(chats.size());
+	for (const auto chat : chats) {
+		inputs.push_back(chat->inputChat);
+	}
+	const auto requestId = request(MTPmessages_GetChats(
+		MTP_vector<MTPint>(inputs)
+	)).done([this](const MTPmessages_Chats &result, mtpRequestId requestId) {
+		gotPeersChats(result, requestId);
+	}).fail([this](const RPCError &error, mtpRequestId requestId) {
+		failPeersRequest(error, requestId);
+	}).priority(MTP::RequestPriority::Background).send();
+	for (const auto chat : chats) {
+		_peerRequests[chat.get()] = requestId;
+	}
+}
+
+void ApiWrap::sendPeersRequest(
+		const std::vector<not_null<ChannelData*>> &channels) {
+	auto inputs = QVector<MTPInputChannel>();
+	inputs.reserve(channels.size());
+	for (const auto channel : channels) {
+		inputs.push_back(channel->inputChannel);
+	}
+	const auto requestId = request(MTPchannels_GetChannels(
+		MTP_vector<MTPInputChannel>(inputs)
+	)).done([this](const MTPmessages_Chats &result, mtpRequestId requestId) {
+		gotPeersChats(result, requestId);
+	}).fail([this](const RPCError &error, mtpRequestId requestId) {
+		failPeersRequest(error, requestId);
+	}).priority(MTP::RequestPriority::Background).send();
+	for (const auto channel : channels) {
+		_peerRequests[channel.get()] = requestId;
+	}
+}
+
+void ApiWrap::gotPeersChats(
+		const MTPmessages_Chats &result,
+		mtpRequestId requestId) {
+	const auto requested = [&](not_null<PeerData*> peer) {
+		const auto i = _peerRequests.constFind(peer.get());
+		return (i != _peerRequests.cend()) && (i.value() == requestId);
+	};
+
+	// If we have a newer version than received we reset it to the received
+	// one and request the peer again after the received data is applied.
+	auto outdated = std::vector<std::pair<not_null<PeerData*>, int>>();
+	if (const auto chats = Api::getChatsFromMessagesChats(result)) {
+		for (const auto &chat : chats->v) {
+			if (chat.type() == mtpc_chat) {
+				const auto &data = chat.c_chat();
+				const auto peer = App::chatLoaded(data.vid.v);
+				if (peer && requested(peer) && data.vversion.v < peer->version) {
+					outdated.emplace_back(peer, data.vversion.v);
 				}
-				auto chat = App::feedChats(*chats);
-				if (chat == peer) {
-					if (badVersion) {
-						if (auto chat = peer->asChat()) {
-							chat->version = v[0].c_chat().vversion.v;
-						} else if (auto channel = peer->asChannel()) {
-							channel->version = v[0].c_channel().vversion.v;
-						}
-						requestPeer(peer);
-					}
+			} else if (chat.type() == mtpc_channel) {
+				const auto &data = chat.c_channel();
+				const auto peer = App::channelLoaded(data.vid.v);
+				if (peer && requested(peer) && data.vversion.v < peer->version) {
+					outdated.emplace_back(peer, data.vversion.v);
 				}
 			}
-		};
-		if (auto user = peer->asUser()) {
-			return request(MTPusers_GetUsers(MTP_vector<MTPInputUser>(1, user->inputUser))).done([this, user](const MTPVector<MTPUser> &result) {
-				_peerRequests.remove(user);
-				App::feedUsers(result);
-			}).fail(failHandler).send();
-		} else if (auto chat = peer->asChat()) {
-			return request(MTPmessages_GetChats(MTP_vector<MTPint>(1, chat->inputChat))).done(chatHandler).fail(failHandler).send();
-		} else if (auto channel = peer->asChannel()) {
-			return request(MTPchannels_GetChannels(MTP_vector<MTPInputChannel>(1, channel->inputChannel))).done(chatHandler).fail(failHandler).send();
 		}
-		return 0;
-	};
-	if (auto requestId = sendRequest()) {
-		_peerRequests.insert(peer, requestId);
+		App::feedChats(*chats);
+	}
+	finalizePeersRequest(requestId);
+
+	for (const auto &[peer, version] : outdated) {
+		if (const auto chat = peer->asChat()) {
+			chat->version = version;
+		} else if (const auto channel = peer->asChannel()) {
+			channel->version = version;
+		}
+		requestPeer(peer);
 	}
 }
 
-void ApiWrap::requestPeers(const QList<PeerData*> &peers) {
-	QVector<MTPint> chats;
-	QVector<MTPInputChannel> channels;
-	QVector<MTPInputUser> users;
-	chats.reserve(peers.size());
-	channels.reserve(peers.size());
-	users.reserve(peers.size());
-	for (QList<PeerData*>::const_iterator i = peers.cbegin(), e = peers.cend(); i != e; ++i) {
-		if (!*i || _fullPeerRequests.contains(*i) || _peerRequests.contains(*i)) continue;
-		if ((*i)->isUser()) {
-			users.push_back((*i)->asUser()->inputUser);
-		} else if ((*i)->isChat()) {
-			chats.push_back((*i)->asChat()->inputChat);
-		} else if ((*i)->isChannel()) {
-			channels.push_back((*i)->asChannel()->inputChannel);
-		}
-	}
-	auto handleChats = [this](const MTPmessages_Chats &result) {
-		if (auto chats = Api::getChatsFromMessagesChats(result)) {
-			App::feedChats(*chats);
+void ApiWrap::failPeersRequest(
+		const RPCError &error,
+		mtpRequestId requestId) {
+	auto failed = std::vector<not_null<PeerData*>>();
+	for (auto i = _peerRequests.cbegin(), e = _peerRequests.cend(); i != e; ++i) {
+		if (i.value() == requestId) {
+			failed.push_back(i.key());
 		}
-	};
-	if (!chats.isEmpty()) {
-		request(MTPmessages_GetChats(MTP_vector<MTPint>(chats))).done(handleChats).send();
 	}
-	if (!channels.isEmpty()) {
-		request(MTPchannels_GetChannels(MTP_vector<MTPInputChannel>(channels))).done(handleChats).send();
+	finalizePeersRequest(requestId);
+	if (failed.size() < 2 || MTP::isTemporaryError(error)) {
+		// A single peer request has failed because of that peer itself,
+		// there is no sense in requesting it again.
+		return;
 	}
-	if (!users.isEmpty()) {
-		request(MTPusers_GetUsers(MTP_vector<MTPInputUser>(users))).done([this](const MTPVector<MTPUser> &result) {
-			App::feedUsers(result);
-		}).send();
+
+	// One bad peer fails the whole batch, so request each peer alone.
+	LOG(("API Error: batch of %1 peers failed with %2, requesting one by one.").arg(failed.size()).arg(error.type()));
+	for (const auto peer : failed) {
+		if (const auto user = peer->asUser()) {
+			sendPeersRequest(std::vector<not_null<UserData*>>(1, user));
+		} else if (const auto chat = peer->asChat()) {
+			sendPeersRequest(std::vector<not_null<ChatData*>>(1, chat));
+		} else if (const auto channel = peer->asChannel()) {
+			sendPeersRequest(std::vector<not_null<ChannelData*>>(1, channel));
+		}
+	}
+}
+
+void ApiWrap::finalizePeersRequest(mtpRequestId requestId) {
+	for (auto i = _peerRequests.begin(); i != _peerRequests.end();) {
+		if (i.value() == requestId) {
+			i = _peerRequests.erase(i);
+		} else {
+			++i;
+		}
 	}
 }
 
@@ -981,7 +1091,7 @@ void ApiWrap::requestStickerSets() {
 			gotStickerSet(setId, result);
 		}).fail([this, setId = i.key()](const RPCError &error) {
 			_stickerSetRequests.remove(setId);
-		}).afterDelay(waitMs).send();
+		}).afterDelay(waitMs).priority(MTP::RequestPriority::Background).send();
 	}
 }
 
@@ -1587,13 +1697,13 @@ void ApiWrap::resolveWebPages() {
 	if (!ids.isEmpty()) {
 		requestId = request(MTPmessages_GetMessages(MTP_vector<MTPint>(ids))).done([this](const MTPmessages_Messages &result, mtpRequestId requestId) {
 			gotWebPages(nullptr, result, requestId);
-		}).afterDelay(kSmallDelayMs).send();
+		}).afterDelay(kSmallDelayMs).priority(MTP::RequestPriority::Background).send();
 	}
 	QVector<mtpRequestId> reqsByIndex(idsByChannel.size(), 0);
 	for (auto i = idsByChannel.cbegin(), e = idsByChannel.cend(); i != e; ++i) {
 		reqsByIndex[i.value().first] = request(MTPchannels_GetMessages(i.key()->inputChannel, MTP_vector<MTPint>(i.value().second))).done([this, channel = i.key()](const MTPmessages_Messages &result, mtpRequestId requestId) {
 			gotWebPages(channel, result, requestId);
-		}).afterDelay(kSmallDelayMs).send();
+		}).afterDelay(kSmallDelayMs).priority(MTP::RequestPriority::Background).send();
 	}
 	if (requestId || !reqsByIndex.isEmpty()) {
 		for (auto &pendingRequestId : _webPagesPending) {
@@ -2532,6 +2642,8 @@ void ApiWrap::forwardMessages(
 			}
 		}).afterRequest(
 			history->sendRequestId
+		).priority(
+			MTP::RequestPriority::Interactive
 		).send();
 
 		ids.resize(0);
@@ -2916,6 +3028,7 @@ void ApiWrap::sendMediaWithRandomId(
 	)).done([=](const MTPUpdates &result) { applyUpdates(result);
 	}).fail([=](const RPCError &error) { sendMessageFail(error);
 	}).afterRequest(history->sendRequestId
+	).priority(MTP::RequestPriority::Interactive
 	).send();
 }
 
@@ -3019,6 +3132,7 @@ void ApiWrap::sendAlbumIfReady(not_null<SendingAlbum*> album) {
 		_sendingAlbums.remove(groupId);
 		sendMessageFail(error);
 	}).afterRequest(history->sendRequestId
+	).priority(MTP::RequestPriority::Interactive
 	).send();
 }
 
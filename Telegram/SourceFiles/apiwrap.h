@@ -238,6 +238,17 @@ private:
 	QVector<MTPint> collectMessageIds(const MessageDataRequests &requests);
 	MessageDataRequests *messageDataRequests(ChannelData *channel, bool onlyExisting = false);
 
+	void resolvePeers();
+	void sendPeersRequest(const std::vector<not_null<UserData*>> &users);
+	void sendPeersRequest(const std::vector<not_null<ChatData*>> &chats);
+	void sendPeersRequest(
+		const std::vector<not_null<ChannelData*>> &channels);
+	void gotPeersChats(
+		const MTPmessages_Chats &result,
+		mtpRequestId requestId);
+	void failPeersRequest(const RPCError &error, mtpRequestId requestId);
+	void finalizePeersRequest(mtpRequestId requestId);
+
 	void gotChatFull(PeerData *peer, const MTPmessages_ChatFull &result, mtpRequestId req);
 	void gotUserFull(UserData *user, const MTPUserFull &result, mtpRequestId req);
 	void applyLastParticipantsList(
@@ -340,6 +351,9 @@ private:
 	using PeerRequests = QMap<PeerData*, mtpRequestId>;
 	PeerRequests _fullPeerRequests;
 	PeerRequests _peerRequests;
+	SingleQueuedInvokation _peersResolveDelayed;
+	int _peersRequested = 0;
+	int _peersRequestsSaved = 0;
 
 	PeerRequests _participantsRequests;
 	PeerRequests _botsRequests;
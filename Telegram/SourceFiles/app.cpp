@@ -37,6 +37,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "storage/storage_facade.h"
 #include "storage/storage_shared_media.h"
+#include "base/flat_hash_map.h"
 #include "window/themes/window_theme.h"
 #include "window/notifications_manager.h"
 #include "platform/platform_notifications_manager.h"
@@ -46,7 +47,7 @@ namespace {
 
 	UserData *self = nullptr;
 
-	using PeersData = QHash<PeerId, PeerData*>;
+	using PeersData = base::flat_hash_map<PeerId, PeerData*>;
 	PeersData peersData;
 
 	using MutedPeers = QMap<not_null<PeerData*>, bool>;
@@ -72,20 +73,25 @@ namespace {
 	GifItems gifItems;
 
 	using DependentItemsSet = OrderedSet<HistoryItem*>;
-	using DependentItems = QMap<HistoryItem*, DependentItemsSet>;
+	using DependentItems = base::flat_hash_map<HistoryItem*, DependentItemsSet>;
 	DependentItems dependentItems;
 
 	Histories histories;
 
-	using MsgsData = QHash<MsgId, HistoryItem*>;
+	using MsgsData = base::flat_hash_map<MsgId, HistoryItem*>;
 	MsgsData msgsData;
-	using ChannelMsgsData = QMap<ChannelId, MsgsData>;
+
+	// Pointers to MsgsData are kept while items are destroyed and
+	// created, so they should survive the registry rehashing.
+	using ChannelMsgsData = base::flat_hash_map<
+		ChannelId,
+		std::unique_ptr<MsgsData>>;
 	ChannelMsgsData channelMsgsData;
 
-	using RandomData = QMap<uint64, FullMsgId>;
+	using RandomData = base::flat_hash_map<uint64, FullMsgId>;
 	RandomData randomData;
 
-	using SentData = QMap<uint64, QPair<PeerId, QString>>;
+	using SentData = base::flat_hash_map<uint64, QPair<PeerId, QString>>;
 	SentData sentData;
 
 	HistoryItem *hoveredItem = nullptr,
@@ -1036,15 +1042,17 @@ namespace {
 
 	inline MsgsData *fetchMsgsData(ChannelId channelId, bool insert = true) {
 		if (channelId == NoChannel) return &msgsData;
-		ChannelMsgsData::iterator i = channelMsgsData.find(channelId);
-		if (i == channelMsgsData.cend()) {
+		auto i = channelMsgsData.find(channelId);
+		if (i == channelMsgsData.end()) {
 			if (insert) {
-				i = channelMsgsData.insert(channelId, MsgsData());
+				i = channelMsgsData.emplace(
+					channelId,
+					std::make_unique<MsgsData>()).first;
 			} else {
 				return 0;
 			}
 		}
-		return &(*i);
+		return i->second.get();
 	}
 
 	void feedWereDeleted(ChannelId channelId, const QVector<MTPint> &msgsIds) {
@@ -1057,10 +1065,11 @@ namespace {
 
 		base::flat_set<not_null<History*>> historiesToCheck;
 		for (const auto msgId : msgsIds) {
-			auto j = data->constFind(msgId.v);
-			if (j != data->cend()) {
-				const auto h = (*j)->history();
-				(*j)->destroy();
+			auto j = data->find(msgId.v);
+			if (j != data->end()) {
+				const auto item = j->second;
+				const auto h = item->history();
+				item->destroy();
 				if (!h->lastMsg) {
 					historiesToCheck.emplace(h);
 				}
@@ -1327,8 +1336,8 @@ namespace {
 	PeerData *peer(const PeerId &id, PeerData::LoadedStatus restriction) {
 		if (!id) return nullptr;
 
-		auto i = peersData.constFind(id);
-		if (i == peersData.cend()) {
+		auto i = peersData.find(id);
+		if (i == peersData.end()) {
 			PeerData *newData = nullptr;
 			if (peerIsUser(id)) {
 				newData = new UserData(id);
@@ -1340,25 +1349,25 @@ namespace {
 			Assert(newData != nullptr);
 
 			newData->input = MTPinputPeer(MTP_inputPeerEmpty());
-			i = peersData.insert(id, newData);
+			i = peersData.emplace(id, newData).first;
 		}
 		switch (restriction) {
 		case PeerData::MinimalLoaded: {
-			if (i.value()->loadedStatus == PeerData::NotLoaded) {
+			if (i->second->loadedStatus == PeerData::NotLoaded) {
 				return nullptr;
 			}
 		} break;
 		case PeerData::FullLoaded: {
-			if (i.value()->loadedStatus != PeerData::FullLoaded) {
+			if (i->second->loadedStatus != PeerData::FullLoaded) {
 				return nullptr;
 			}
 		} break;
 		}
-		return i.value();
+		return i->second;
 	}
 
 	void enumerateUsers(base::lambda<void(UserData*)> action) {
-		for_const (auto peer, peersData) {
+		for (const auto &[peerId, peer] : peersData) {
 			if (auto user = peer->asUser()) {
 				action(user);
 			}
@@ -1371,7 +1380,7 @@ namespace {
 
 	PeerData *peerByName(const QString &username) {
 		QString uname(username.trimmed());
-		for_const (PeerData *peer, peersData) {
+		for (const auto &[peerId, peer] : peersData) {
 			if (!peer->userName().compare(uname, Qt::CaseInsensitive)) {
 				return peer;
 			}
@@ -1795,22 +1804,22 @@ namespace {
 		auto data = fetchMsgsData(channelId, false);
 		if (!data) return nullptr;
 
-		auto i = data->constFind(itemId);
-		if (i != data->cend()) {
-			return i.value();
+		auto i = data->find(itemId);
+		if (i != data->end()) {
+			return i->second;
 		}
 		return nullptr;
 	}
 
 	void historyRegItem(HistoryItem *item) {
 		MsgsData *data = fetchMsgsData(item->channelId());
-		MsgsData::const_iterator i = data->constFind(item->id);
-		if (i == data->cend()) {
-			data->insert(item->id, item);
-		} else if (i.value() != item) {
+		auto i = data->find(item->id);
+		if (i == data->end()) {
+			data->emplace(item->id, item);
+		} else if (i->second != item) {
 			LOG(("App Error: trying to historyRegItem() an already registered item"));
-			i.value()->destroy();
-			data->insert(item->id, item);
+			i->second->destroy();
+			(*data)[item->id] = item;
 		}
 	}
 
@@ -1840,19 +1849,14 @@ namespace {
 		if (!data) return;
 
 		auto i = data->find(item->id);
-		if (i != data->cend()) {
-			if (i.value() == item) {
+		if (i != data->end()) {
+			if (i->second == item) {
 				data->erase(i);
 			}
 		}
 		historyItemDetached(item);
-		auto j = ::dependentItems.find(item);
-		if (j != ::dependentItems.cend()) {
-			DependentItemsSet items;
-			std::swap(items, j.value());
-			::dependentItems.erase(j);
-
-			for_const (auto dependent, items) {
+		if (const auto items = ::dependentItems.take(item)) {
+			for_const (auto dependent, *items) {
 				dependent->dependencyItemRemoved(item);
 			}
 		}
@@ -1865,9 +1869,12 @@ namespace {
 	}
 
 	void historyUpdateDependent(HistoryItem *item) {
-		DependentItems::iterator j = ::dependentItems.find(item);
-		if (j != ::dependentItems.cend()) {
-			for_const (HistoryItem *dependent, j.value()) {
+		const auto j = ::dependentItems.find(item);
+		if (j != ::dependentItems.end()) {
+			// Updates may register or remove dependencies and
+			// move the values of the registry.
+			const auto dependents = j->second;
+			for_const (HistoryItem *dependent, dependents) {
 				dependent->updateDependencyItem();
 			}
 		}
@@ -1880,13 +1887,13 @@ namespace {
 		::dependentItems.clear();
 
 		QVector<HistoryItem*> toDelete;
-		for_const (auto item, msgsData) {
+		for (const auto &[msgId, item] : msgsData) {
 			if (item->detached()) {
 				toDelete.push_back(item);
 			}
 		}
-		for_const (auto &chMsgsData, channelMsgsData) {
-			for_const (auto item, chMsgsData) {
+		for (const auto &[channelId, chMsgsData] : channelMsgsData) {
+			for (const auto &[msgId, item] : *chMsgsData) {
 				if (item->detached()) {
 					toDelete.push_back(item);
 				}
@@ -1909,7 +1916,7 @@ namespace {
 		cSetSavedPeersByTime(SavedPeersByTime());
 		cSetRecentInlineBots(RecentInlineBots());
 
-		for_const (auto peer, ::peersData) {
+		for (const auto &[peerId, peer] : ::peersData) {
 			delete peer;
 		}
 		::peersData.clear();
@@ -1956,16 +1963,20 @@ namespace {
 
 	void historyUnregDependency(HistoryItem *dependent, HistoryItem *dependency) {
 		auto i = ::dependentItems.find(dependency);
-		if (i != ::dependentItems.cend()) {
-			i.value().remove(dependent);
-			if (i.value().isEmpty()) {
+		if (i != ::dependentItems.end()) {
+			i->second.remove(dependent);
+			if (i->second.isEmpty()) {
 				::dependentItems.erase(i);
 			}
 		}
 	}
 
+	bool historyItemHasDependents(HistoryItem *item) {
+		return ::dependentItems.contains(item);
+	}
+
 	void historyRegRandom(uint64 randomId, const FullMsgId &itemId) {
-		randomData.insert(randomId, itemId);
+		randomData[randomId] = itemId;
 	}
 
 	void historyUnregRandom(uint64 randomId) {
@@ -1973,15 +1984,15 @@ namespace {
 	}
 
 	FullMsgId histItemByRandom(uint64 randomId) {
-		RandomData::const_iterator i = randomData.constFind(randomId);
-		if (i != randomData.cend()) {
-			return i.value();
+		const auto i = randomData.find(randomId);
+		if (i != randomData.end()) {
+			return i->second;
 		}
 		return FullMsgId();
 	}
 
 	void historyRegSentData(uint64 randomId, const PeerId &peerId, const QString &text) {
-		sentData.insert(randomId, qMakePair(peerId, text));
+		sentData[randomId] = qMakePair(peerId, text);
 	}
 
 	void historyUnregSentData(uint64 randomId) {
@@ -1989,9 +2000,14 @@ namespace {
 	}
 
 	void histSentDataByItem(uint64 randomId, PeerId &peerId, QString &text) {
-		QPair<PeerId, QString> d = sentData.value(randomId);
-		peerId = d.first;
-		text = d.second;
+		const auto i = sentData.find(randomId);
+		if (i != sentData.end()) {
+			peerId = i->second.first;
+			text = i->second.second;
+		} else {
+			peerId = PeerId();
+			text = QString();
+		}
 	}
 
 	void prepareCorners(RoundCorners index, int32 radius, const QBrush &brush, const style::color *shadow = nullptr, QImage *cors = nullptr) {
@@ -2305,7 +2321,7 @@ namespace {
 		App::quit();
 	}
 
-	QImage readImage(QByteArray data, QByteArray *format, bool opaque, bool *animated) {
+	QImage readImage(QByteArray data, QByteArray *format, bool opaque, bool *animated, QSize shrinkBox) {
         QByteArray tmpFormat;
 		QImage result;
 		QBuffer buffer(&data);
@@ -2320,6 +2336,21 @@ namespace {
 			if (animated) *animated = reader.supportsAnimation() && reader.imageCount() > 1;
 			QByteArray fmt = reader.format();
 			if (!fmt.isEmpty()) *format = fmt;
+#ifndef OS_MAC_OLD
+			if (!shrinkBox.isEmpty()) {
+				// The jpeg handler decodes a downscaled image right from
+				// the DCT coefficients, so large photos are never decoded
+				// in their full size. The size from the header is before
+				// the EXIF rotation, which is applied after the scaling.
+				auto size = reader.size();
+				if (reader.transformation() & QImageIOHandler::TransformationRotate90) {
+					shrinkBox.transpose();
+				}
+				if (size.width() > shrinkBox.width() || size.height() > shrinkBox.height()) {
+					reader.setScaledSize(size.scaled(shrinkBox, Qt::KeepAspectRatio));
+				}
+			}
+#endif // OS_MAC_OLD
 			if (!reader.read(&result)) {
 				return QImage();
 			}
@@ -197,6 +197,7 @@ namespace App {
 	void historyClearItems();
 	void historyRegDependency(HistoryItem *dependent, HistoryItem *dependency);
 	void historyUnregDependency(HistoryItem *dependent, HistoryItem *dependency);
+	bool historyItemHasDependents(HistoryItem *item);
 
 	void historyRegRandom(uint64 randomId, const FullMsgId &itemId);
 	void historyUnregRandom(uint64 randomId);
@@ -246,7 +247,8 @@ namespace App {
 
 	constexpr auto kFileSizeLimit = 1500 * 1024 * 1024; // Load files up to 1500mb
 	constexpr auto kImageSizeLimit = 64 * 1024 * 1024; // Open images up to 64mb jpg/png/gif
-	QImage readImage(QByteArray data, QByteArray *format = nullptr, bool opaque = true, bool *animated = nullptr);
+	// If !shrinkBox.isEmpty() then the image is decoded already fitting in it.
+	QImage readImage(QByteArray data, QByteArray *format = nullptr, bool opaque = true, bool *animated = nullptr, QSize shrinkBox = QSize());
 	QImage readImage(const QString &file, QByteArray *format = nullptr, bool opaque = true, bool *animated = nullptr, QByteArray *content = 0);
 	QPixmap pixmapFromImageInPlace(QImage &&image);
 
@@ -207,6 +207,7 @@ rpl::producer<not_null<const HistoryItem*>> AuthSessionData::itemRepaintRequest(
 }
 
 void AuthSessionData::markItemRemoved(not_null<const HistoryItem*> item) {
+	_searchIndex.remove(item);
 	_itemRemoved.fire_copy(item);
 }
 
@@ -12,6 +12,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <rpl/variable.h>
 #include "base/timer.h"
 #include "chat_helpers/stickers.h"
+#include "chat_helpers/stickers_decoder.h"
+#include "data/data_search_index.h"
 
 class ApiWrap;
 enum class SendFilesWay;
@@ -62,12 +64,28 @@ public:
 	base::Observable<ItemVisibilityQuery> &queryItemVisibility() {
 		return _queryItemVisibility;
 	}
+
+	// Widgets that hold item pointers report them here, so that those
+	// items or the whole histories of the peers are not unloaded.
+	struct ItemsInUseQuery {
+		not_null<base::flat_set<not_null<HistoryItem*>>*> items;
+		not_null<base::flat_set<not_null<PeerData*>>*> peers;
+	};
+	base::Observable<ItemsInUseQuery> &queryItemsInUse() {
+		return _queryItemsInUse;
+	}
 	void markItemLayoutChanged(not_null<const HistoryItem*> item);
 	rpl::producer<not_null<const HistoryItem*>> itemLayoutChanged() const;
 	void requestItemRepaint(not_null<const HistoryItem*> item);
 	rpl::producer<not_null<const HistoryItem*>> itemRepaintRequest() const;
 	void markItemRemoved(not_null<const HistoryItem*> item);
 	rpl::producer<not_null<const HistoryItem*>> itemRemoved() const;
+	Data::SearchIndex &searchIndex() {
+		return _searchIndex;
+	}
+	Stickers::Decoder &stickersDecoder() {
+		return _stickersDecoder;
+	}
 	void markHistoryUnloaded(not_null<const History*> history);
 	rpl::producer<not_null<const History*>> historyUnloaded() const;
 	void markHistoryCleared(not_null<const History*> history);
@@ -299,9 +317,12 @@ private:
 	base::Observable<void> _moreChatsLoaded;
 	base::Observable<void> _pendingHistoryResize;
 	base::Observable<ItemVisibilityQuery> _queryItemVisibility;
+	base::Observable<ItemsInUseQuery> _queryItemsInUse;
 	rpl::event_stream<not_null<const HistoryItem*>> _itemLayoutChanged;
 	rpl::event_stream<not_null<const HistoryItem*>> _itemRepaintRequest;
 	rpl::event_stream<not_null<const HistoryItem*>> _itemRemoved;
+	Data::SearchIndex _searchIndex;
+	Stickers::Decoder _stickersDecoder;
 	rpl::event_stream<not_null<const History*>> _historyUnloaded;
 	rpl::event_stream<not_null<const History*>> _historyCleared;
 	rpl::event_stream<MegagroupParticipant> _megagroupParticipantRemoved;
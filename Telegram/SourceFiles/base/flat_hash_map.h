@@ -0,0 +1,263 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "base/flat_map.h"
+#include "base/optional.h"
+
+namespace base {
+
+// Hash map with the values kept densely in one vector and an open
+// addressing (linear probing) index table pointing into it.
+//
+// Lookups touch one small index slot and one value, iteration walks
+// the values vector. The order of iteration is unspecified, erasing
+// moves the last value into the erased position, so any insertion or
+// erasing invalidates all the iterators, pointers and references.
+template <
+	typename Key,
+	typename Type,
+	typename Hash = std::hash<Key>>
+class flat_hash_map {
+	using pair_type = flat_multi_map_pair_type<Key, Type>;
+	using impl_t = std::vector<pair_type>;
+
+public:
+	using value_type = pair_type;
+	using size_type = typename impl_t::size_type;
+	using difference_type = typename impl_t::difference_type;
+	using pointer = pair_type*;
+	using const_pointer = const pair_type*;
+	using reference = pair_type&;
+	using const_reference = const pair_type&;
+	using iterator = typename impl_t::iterator;
+	using const_iterator = typename impl_t::const_iterator;
+
+	flat_hash_map() = default;
+	flat_hash_map(std::initializer_list<pair_type> list) {
+		reserve(list.size());
+		for (const auto &value : list) {
+			insert(value);
+		}
+	}
+
+	size_type size() const {
+		return _values.size();
+	}
+	bool empty() const {
+		return _values.empty();
+	}
+	void clear() {
+		_values.clear();
+		_index.clear();
+		_shift = kMaxShift;
+	}
+	void reserve(size_type size) {
+		_values.reserve(size);
+		if (capacityFor(size) > _index.size()) {
+			rehash(capacityFor(size));
+		}
+	}
+
+	iterator begin() {
+		return _values.begin();
+	}
+	iterator end() {
+		return _values.end();
+	}
+	const_iterator begin() const {
+		return _values.begin();
+	}
+	const_iterator end() const {
+		return _values.end();
+	}
+	const_iterator cbegin() const {
+		return _values.cbegin();
+	}
+	const_iterator cend() const {
+		return _values.cend();
+	}
+
+	std::pair<iterator, bool> insert(const value_type &value) {
+		return try_emplace(value.first, value.second);
+	}
+	std::pair<iterator, bool> insert(value_type &&value) {
+		return try_emplace(value.first, std::move(value.second));
+	}
+	template <typename... Args>
+	std::pair<iterator, bool> emplace(
+			const Key &key,
+			Args&&... args) {
+		return try_emplace(key, std::forward<Args>(args)...);
+	}
+	template <typename... Args>
+	std::pair<iterator, bool> try_emplace(
+			const Key &key,
+			Args&&... args) {
+		if (const auto index = findIndex(key); index >= 0) {
+			return { _values.begin() + index, false };
+		}
+		return {
+			append(key, Type(std::forward<Args>(args)...)),
+			true
+		};
+	}
+
+	iterator find(const Key &key) {
+		const auto index = findIndex(key);
+		return (index >= 0) ? (_values.begin() + index) : _values.end();
+	}
+	const_iterator find(const Key &key) const {
+		const auto index = findIndex(key);
+		return (index >= 0) ? (_values.begin() + index) : _values.end();
+	}
+	bool contains(const Key &key) const {
+		return (findIndex(key) >= 0);
+	}
+
+	Type &operator[](const Key &key) {
+		if (const auto index = findIndex(key); index >= 0) {
+			return _values[index].second;
+		}
+		return append(key, Type())->second;
+	}
+
+	bool remove(const Key &key) {
+		const auto i = find(key);
+		if (i == end()) {
+			return false;
+		}
+		erase(i);
+		return true;
+	}
+
+	// Returns the iterator to the value that took the erased position.
+	iterator erase(const_iterator where) {
+		const auto index = size_type(where - _values.cbegin());
+		Expects(index < _values.size());
+
+		removeSlot(slotOf(index));
+		const auto last = _values.size() - 1;
+		if (index != last) {
+			_index[slotOf(last)] = slot_type(index + 1);
+			_values[index] = std::move(_values[last]);
+		}
+		_values.pop_back();
+		return _values.begin() + index;
+	}
+
+	optional<Type> take(const Key &key) {
+		auto it = find(key);
+		if (it == end()) {
+			return base::none;
+		}
+		auto result = optional<Type>(std::move(it->second));
+		erase(it);
+		return result;
+	}
+
+private:
+	// Index slots keep (value index + 1), zero is an empty slot.
+	using slot_type = std::uint32_t;
+
+	static constexpr auto kMinCapacity = size_type(8);
+	static constexpr auto kMaxShift = 64;
+
+	static size_type capacityFor(size_type size) {
+		// Keep the load factor under 3/4.
+		auto result = kMinCapacity;
+		while (result * 3 < size * 4) {
+			result *= 2;
+		}
+		return result;
+	}
+
+	size_type mask() const {
+		return _index.size() - 1;
+	}
+	size_type idealSlot(const Key &key) const {
+		// Fibonacci hashing, so that std::hash of pointers and of
+		// sequential ids is spread over the whole table.
+		const auto hash = std::uint64_t(Hash()(key));
+		return size_type((hash * 0x9E3779B97F4A7C15ULL) >> _shift);
+	}
+
+	int findIndex(const Key &key) const {
+		if (_index.empty()) {
+			return -1;
+		}
+		for (auto slot = idealSlot(key);; slot = (slot + 1) & mask()) {
+			const auto value = _index[slot];
+			if (!value) {
+				return -1;
+			} else if (_values[value - 1].first == key) {
+				return int(value - 1);
+			}
+		}
+	}
+	size_type slotOf(size_type index) const {
+		const auto value = slot_type(index + 1);
+		for (auto slot = idealSlot(_values[index].first);; slot = (slot + 1) & mask()) {
+			if (_index[slot] == value) {
+				return slot;
+			}
+		}
+	}
+	void placeSlot(size_type index) {
+		auto slot = idealSlot(_values[index].first);
+		while (_index[slot]) {
+			slot = (slot + 1) & mask();
+		}
+		_index[slot] = slot_type(index + 1);
+	}
+
+	// Backward shift deletion, so that no tombstones are needed.
+	void removeSlot(size_type slot) {
+		auto empty = slot;
+		for (auto next = (slot + 1) & mask(); _index[next]; next = (next + 1) & mask()) {
+			const auto ideal = idealSlot(_values[_index[next] - 1].first);
+			const auto distanceNext = (next - ideal) & mask();
+			const auto distanceEmpty = (next - empty) & mask();
+			if (distanceNext >= distanceEmpty) {
+				_index[empty] = _index[next];
+				empty = next;
+			}
+		}
+		_index[empty] = 0;
+	}
+
+	iterator append(const Key &key, Type &&value) {
+		if (capacityFor(_values.size() + 1) > _index.size()) {
+			rehash(capacityFor(_values.size() + 1));
+		}
+		_values.emplace_back(key, std::move(value));
+		placeSlot(_values.size() - 1);
+		return _values.end() - 1;
+	}
+
+	void rehash(size_type capacity) {
+		_index.assign(capacity, slot_type(0));
+		_shift = kMaxShift;
+		for (auto i = capacity; i > 1; i >>= 1) {
+			--_shift;
+		}
+		for (auto i = size_type(0), count = _values.size(); i != count; ++i) {
+			placeSlot(i);
+		}
+	}
+
+	impl_t _values;
+	std::vector<slot_type> _index;
+	int _shift = kMaxShift;
+
+};
+
+} // namespace base
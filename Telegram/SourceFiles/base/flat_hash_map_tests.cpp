@@ -0,0 +1,137 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/flat_hash_map.h"
+#include <map>
+#include <random>
+#include <string>
+
+struct int_wrap {
+	int value;
+};
+inline bool operator==(const int_wrap &a, const int_wrap &b) {
+	return a.value == b.value;
+}
+struct int_wrap_bad_hash {
+	// All the values go to the same slot to test long probe chains.
+	inline std::size_t operator()(const int_wrap &) const {
+		return 0;
+	}
+};
+
+using namespace std;
+
+TEST_CASE("flat_hash_maps should find inserted items", "[flat_hash_map]") {
+	base::flat_hash_map<int, string> v;
+	REQUIRE(v.emplace(0, "a").second);
+	REQUIRE(v.emplace(5, "b").second);
+	REQUIRE(v.emplace(4, "d").second);
+	REQUIRE(v.emplace(2, "e").second);
+	REQUIRE(v.size() == 4);
+
+	SECTION("inserting existing key keeps the old value") {
+		const auto result = v.emplace(5, "c");
+		REQUIRE(!result.second);
+		REQUIRE(result.first->second == "b");
+		REQUIRE(v.size() == 4);
+	}
+
+	SECTION("lookup finds only inserted keys") {
+		REQUIRE(v.find(4) != v.end());
+		REQUIRE(v.find(4)->second == "d");
+		REQUIRE(v.contains(0));
+		REQUIRE(!v.contains(1));
+		REQUIRE(v.find(3) == v.end());
+	}
+
+	SECTION("removing keeps other items") {
+		REQUIRE(v.remove(4));
+		REQUIRE(!v.remove(4));
+		REQUIRE(v.size() == 3);
+		REQUIRE(v[0] == "a");
+		REQUIRE(v[5] == "b");
+		REQUIRE(v[2] == "e");
+		REQUIRE(v.size() == 3);
+	}
+
+	SECTION("take returns the removed value") {
+		REQUIRE(*v.take(2) == "e");
+		REQUIRE(!v.take(2));
+		REQUIRE(v.size() == 3);
+	}
+}
+
+TEST_CASE("flat_hash_maps erase while iterating", "[flat_hash_map]") {
+	base::flat_hash_map<int, int> v;
+	for (auto i = 0; i != 100; ++i) {
+		v.emplace(i, i * i);
+	}
+	for (auto i = v.begin(); i != v.end();) {
+		if (i->first % 3) {
+			i = v.erase(i);
+		} else {
+			++i;
+		}
+	}
+	REQUIRE(v.size() == 34);
+	for (auto i = 0; i != 100; ++i) {
+		REQUIRE(v.contains(i) == !(i % 3));
+	}
+}
+
+TEST_CASE("flat_hash_maps with colliding hashes", "[flat_hash_map]") {
+	base::flat_hash_map<int_wrap, int, int_wrap_bad_hash> v;
+	for (auto i = 0; i != 50; ++i) {
+		v.emplace({ i }, i);
+	}
+	for (auto i = 0; i < 50; i += 2) {
+		REQUIRE(v.remove({ i }));
+	}
+	REQUIRE(v.size() == 25);
+	for (auto i = 0; i != 50; ++i) {
+		const auto found = v.find({ i });
+		if (i % 2) {
+			REQUIRE(found != v.end());
+			REQUIRE(found->second == i);
+		} else {
+			REQUIRE(found == v.end());
+		}
+	}
+}
+
+TEST_CASE("flat_hash_maps work as std::map", "[flat_hash_map]") {
+	auto generator = std::mt19937(20180211);
+	auto key = std::uniform_int_distribution<int>(0, 2000);
+	base::flat_hash_map<int, int> v;
+	std::map<int, int> check;
+	for (auto i = 0; i != 100000; ++i) {
+		const auto k = key(generator);
+		switch (generator() % 4) {
+		case 0:
+		case 1:
+			REQUIRE(v.emplace(k, i).second == check.emplace(k, i).second);
+			break;
+		case 2:
+			REQUIRE(v.remove(k) == (check.erase(k) > 0));
+			break;
+		case 3: {
+			const auto found = v.find(k);
+			const auto checked = check.find(k);
+			REQUIRE((found == v.end()) == (checked == check.end()));
+			if (found != v.end()) {
+				REQUIRE(found->second == checked->second);
+			}
+		} break;
+		}
+		REQUIRE(v.size() == check.size());
+	}
+	for (const auto &[k, value] : v) {
+		REQUIRE(check[k] == value);
+	}
+}
@@ -7,6 +7,70 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "base/runtime_composer.h"
 
+namespace {
+
+constexpr auto kSizeClassStep = std::size_t(16);
+constexpr auto kSizeClassesCount = std::size_t(32);
+constexpr auto kMaxFreeBlocks = std::size_t(1024);
+
+} // namespace
+
+class RuntimeComposerPool {
+public:
+	explicit RuntimeComposerPool(std::size_t size) : _size(size) {
+	}
+	RuntimeComposerPool(const RuntimeComposerPool &other) = delete;
+	RuntimeComposerPool &operator=(const RuntimeComposerPool &other) = delete;
+
+	void *allocate() {
+		{
+			QMutexLocker lock(&_mutex);
+			if (!_free.empty()) {
+				const auto result = _free.back();
+				_free.pop_back();
+				return result;
+			}
+		}
+		return operator new(_size);
+	}
+	void free(void *data) {
+		{
+			QMutexLocker lock(&_mutex);
+			if (_free.size() < kMaxFreeBlocks) {
+				_free.push_back(data);
+				return;
+			}
+		}
+		operator delete(data);
+	}
+
+private:
+	const std::size_t _size = 0;
+	QMutex _mutex;
+	std::vector<void*> _free;
+
+};
+
+namespace {
+
+RuntimeComposerPool *ChoosePool(std::size_t size) {
+	// Called with the metadatas mutex locked. Pools are never destroyed,
+	// so that composers in static storage can free their data on exit.
+	static RuntimeComposerPool *Pools[kSizeClassesCount] = { nullptr };
+
+	const auto index = (size + kSizeClassStep - 1) / kSizeClassStep - 1;
+	if (index >= kSizeClassesCount) {
+		return nullptr;
+	}
+	if (!Pools[index]) {
+		Pools[index] = new RuntimeComposerPool(
+			(index + 1) * kSizeClassStep);
+	}
+	return Pools[index];
+}
+
+} // namespace
+
 struct RuntimeComposerMetadatasMap {
 	QMap<uint64, RuntimeComposerMetadata*> data;
 	~RuntimeComposerMetadatasMap() {
@@ -26,11 +90,25 @@ const RuntimeComposerMetadata *GetRuntimeComposerMetadata(uint64 mask) {
 		RuntimeComposerMetadata *meta = new RuntimeComposerMetadata(mask);
 		Assert(meta != nullptr);
 
+		meta->pool = ChoosePool(meta->size);
+
 		i = RuntimeComposerMetadatas.data.insert(mask, meta);
 	}
 	return i.value();
 }
 
+void *AllocateRuntimeComposerData(const RuntimeComposerMetadata *meta) {
+	return meta->pool ? meta->pool->allocate() : operator new(meta->size);
+}
+
+void FreeRuntimeComposerData(const RuntimeComposerMetadata *meta, void *data) {
+	if (meta->pool) {
+		meta->pool->free(data);
+	} else {
+		operator delete(data);
+	}
+}
+
 const RuntimeComposerMetadata *RuntimeComposer::ZeroRuntimeComposerMetadata = GetRuntimeComposerMetadata(0);
 
 RuntimeComponentWrapStruct RuntimeComponentWraps[64];
@@ -88,6 +88,8 @@ protected:
 
 };
 
+class RuntimeComposerPool;
+
 class RuntimeComposerMetadata {
 public:
 	RuntimeComposerMetadata(uint64 mask) : _mask(mask) {
@@ -117,6 +119,9 @@ public:
 	std::size_t offsets[64] = { 0 };
 	int last = 64;
 
+	// Shared by all the masks that have the same rounded up data size.
+	RuntimeComposerPool *pool = nullptr;
+
 	bool equals(uint64 mask) const {
 		return _mask == mask;
 	}
@@ -134,13 +139,18 @@ private:
 
 const RuntimeComposerMetadata *GetRuntimeComposerMetadata(uint64 mask);
 
+// Data blocks are taken from a free list of the size class of the mask,
+// so that items created and destroyed in bulk don't reach the allocator.
+void *AllocateRuntimeComposerData(const RuntimeComposerMetadata *meta);
+void FreeRuntimeComposerData(const RuntimeComposerMetadata *meta, void *data);
+
 class RuntimeComposer {
 public:
 	RuntimeComposer(uint64 mask = 0) : _data(zerodata()) {
 		if (mask) {
 			auto meta = GetRuntimeComposerMetadata(mask);
 
-			auto data = operator new(meta->size);
+			auto data = AllocateRuntimeComposerData(meta);
 			Assert(data != nullptr);
 
 			_data = data;
@@ -158,11 +168,12 @@ public:
 					} catch (...) {
 						while (i > 0) {
 							--i;
-							offset = meta->offsets[--i];
+							offset = meta->offsets[i];
 							if (offset >= sizeof(_meta())) {
 								RuntimeComponentWraps[i].Destruct(_dataptrunsafe(offset));
 							}
 						}
+						FreeRuntimeComposerData(meta, data);
 						throw;
 					}
 				}
@@ -180,7 +191,7 @@ public:
 					RuntimeComponentWraps[i].Destruct(_dataptrunsafe(offset));
 				}
 			}
-			operator delete(_data);
+			FreeRuntimeComposerData(meta, _data);
 		}
 	}
 
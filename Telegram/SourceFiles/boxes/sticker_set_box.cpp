@@ -372,7 +372,7 @@ void StickerSetBox::Inner::paintEvent(QPaintEvent *e) {
 					doc->automaticLoad(0);
 				}
 				if (doc->sticker()->img->isNull() && doc->loaded(DocumentData::FilePathResolveChecked)) {
-					doc->sticker()->img = doc->data().isEmpty() ? ImagePtr(doc->filepath()) : ImagePtr(doc->data());
+					Auth().data().stickersDecoder().requestImage(doc);
 				}
 			}
 
@@ -55,6 +55,9 @@ public:
 	bool hasItems() const {
 		return !_items.empty();
 	}
+	const std::vector<not_null<HistoryItem*>> &items() const {
+		return _items;
+	}
 
 	MsgId minItemId() const {
 		Expects(hasItems());
@@ -214,6 +217,14 @@ void BoxController::prepare() {
 			delegate()->peerListRefreshRows();
 		}
 	}, lifetime());
+	subscribe(Auth().data().queryItemsInUse(), [this](const AuthSessionData::ItemsInUseQuery &query) {
+		for (auto i = 0, count = delegate()->peerListFullRowsCount(); i != count; ++i) {
+			const auto row = static_cast<Row*>(delegate()->peerListRowAt(i).get());
+			for (const auto item : row->items()) {
+				query.items->emplace(item);
+			}
+		}
+	});
 	subscribe(Current().newServiceMessage(), [this](const FullMsgId &msgId) {
 		if (auto item = App::histItemById(msgId)) {
 			insertRow(item, InsertWay::Prepend);
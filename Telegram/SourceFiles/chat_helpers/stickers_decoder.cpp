@@ -0,0 +1,153 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "chat_helpers/stickers_decoder.h"
+
+#include "data/data_document.h"
+#include "auth_session.h"
+
+namespace Stickers {
+namespace {
+
+constexpr auto kDecodeWorkersCount = 2;
+
+// Panel cells are about 64x64, so with retina images it is up to 32mb.
+constexpr auto kPanelsCacheLimit = std::size_t(512);
+
+} // namespace
+
+void Decoder::requestImage(not_null<DocumentData*> document) {
+	addRequest(document, QSize());
+}
+
+QPixmap Decoder::panelPixmap(not_null<DocumentData*> document, QSize size) {
+	const auto pixelSize = size * cIntRetinaFactor();
+	const auto i = _panels.find(document->id);
+	if (i != _panels.end() && i->second.size == pixelSize) {
+		i->second.lastUsed = ++_panelsUsed;
+		return i->second.pixmap;
+	}
+	if (document->loaded()) {
+		addRequest(document, pixelSize);
+	}
+	return QPixmap();
+}
+
+void Decoder::documentReloaded(not_null<DocumentData*> document) {
+	_failed.remove(document->id);
+}
+
+void Decoder::addRequest(
+		not_null<DocumentData*> document,
+		QSize panelSize) {
+	if (_decoding.contains(document->id) || _failed.contains(document->id)) {
+		return;
+	}
+	const auto i = ranges::find(_requests, document, &Request::document);
+	if (i != end(_requests)) {
+		if (panelSize.isEmpty()) {
+			panelSize = i->panelSize;
+		}
+		_requests.erase(i);
+	}
+	_requests.push_back({ document, panelSize });
+	decodeNext();
+}
+
+void Decoder::decodeNext() {
+	while (_workers < kDecodeWorkersCount && !_requests.empty()) {
+		const auto request = _requests.back();
+		_requests.pop_back();
+
+		const auto document = request.document;
+		auto location = document->location(true);
+		auto bytes = document->data();
+		if (bytes.isEmpty() && !location.accessEnable()) {
+			_failed.emplace(document->id);
+			continue;
+		}
+		_decoding.emplace(document->id);
+		++_workers;
+
+		const auto weak = make_weak(this);
+		crl::async([=] {
+			auto decoded = Decoded();
+			decoded.bytes = bytes;
+			if (decoded.bytes.isEmpty()) {
+				// Keep the file content for the ImagePtr, so that it never
+				// has to encode the pixmap again when it is forgotten.
+				QFile file(location.name());
+				if (file.open(QIODevice::ReadOnly)) {
+					decoded.bytes = file.readAll();
+				}
+			}
+			decoded.image = App::readImage(
+				decoded.bytes,
+				&decoded.format,
+				false);
+			if (!decoded.image.isNull()) {
+				decoded.image = decoded.image.convertToFormat(
+					QImage::Format_ARGB32_Premultiplied);
+				if (!request.panelSize.isEmpty()) {
+					decoded.panelImage = decoded.image.scaled(
+						request.panelSize,
+						Qt::IgnoreAspectRatio,
+						Qt::SmoothTransformation);
+				}
+			}
+			crl::on_main(weak, [=, decoded = std::move(decoded)]() mutable {
+				if (bytes.isEmpty()) {
+					location.accessDisable();
+				}
+				--_workers;
+				_decoding.remove(document->id);
+				applyDecoded(document, std::move(decoded));
+				decodeNext();
+			});
+		});
+	}
+}
+
+void Decoder::applyDecoded(
+		not_null<DocumentData*> document,
+		Decoded &&decoded) {
+	if (decoded.image.isNull()) {
+		_failed.emplace(document->id);
+		return;
+	}
+	if (!decoded.panelImage.isNull()) {
+		decoded.panelImage.setDevicePixelRatio(cRetinaFactor());
+		rememberPanel(
+			document->id,
+			App::pixmapFromImageInPlace(std::move(decoded.panelImage)));
+	}
+	if (const auto sticker = document->sticker()) {
+		if (sticker->img->isNull()) {
+			sticker->img = ImagePtr(
+				decoded.bytes,
+				decoded.format,
+				App::pixmapFromImageInPlace(std::move(decoded.image)));
+		}
+	}
+	Auth().downloaderTaskFinished().notify();
+}
+
+void Decoder::rememberPanel(DocumentId id, QPixmap &&pixmap) {
+	if (_panels.size() >= kPanelsCacheLimit && !_panels.contains(id)) {
+		const auto oldest = ranges::min_element(
+			_panels,
+			std::less<>(),
+			[](const auto &pair) { return pair.second.lastUsed; });
+		_panels.erase(oldest);
+	}
+	auto &panel = _panels[id];
+	panel.size = pixmap.size();
+	panel.pixmap = std::move(pixmap);
+	panel.lastUsed = ++_panelsUsed;
+}
+
+} // namespace Stickers
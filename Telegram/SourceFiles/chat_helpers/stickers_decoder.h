@@ -0,0 +1,64 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+#include "base/flat_hash_map.h"
+
+namespace Stickers {
+
+// Decodes loaded sticker images on background threads.
+//
+// The requests come from painting, so the ones made last are for the
+// stickers visible right now and they are decoded first. The sticker
+// images scaled to the panel cell size are kept in a bounded cache, so
+// that painting a panel never decodes or scales the full images again.
+class Decoder : public base::has_weak_ptr {
+public:
+	// The decoded image is put to StickerData::img.
+	void requestImage(not_null<DocumentData*> document);
+
+	// Returns a null pixmap and requests decoding if not cached yet.
+	QPixmap panelPixmap(not_null<DocumentData*> document, QSize size);
+
+	// Allows decoding the document again if it has failed before.
+	void documentReloaded(not_null<DocumentData*> document);
+
+private:
+	struct Request {
+		not_null<DocumentData*> document;
+		QSize panelSize; // In pixels, empty if not needed.
+	};
+	struct Decoded {
+		QByteArray bytes;
+		QByteArray format;
+		QImage image;
+		QImage panelImage;
+	};
+	struct Panel {
+		QSize size;
+		QPixmap pixmap;
+		uint64 lastUsed = 0;
+	};
+
+	void addRequest(not_null<DocumentData*> document, QSize panelSize);
+	void decodeNext();
+	void applyDecoded(not_null<DocumentData*> document, Decoded &&decoded);
+	void rememberPanel(DocumentId id, QPixmap &&pixmap);
+
+	std::vector<Request> _requests;
+	base::flat_set<DocumentId> _decoding;
+	base::flat_set<DocumentId> _failed;
+	int _workers = 0;
+
+	base::flat_hash_map<DocumentId, Panel> _panels;
+	uint64 _panelsUsed = 0;
+
+};
+
+} // namespace Stickers
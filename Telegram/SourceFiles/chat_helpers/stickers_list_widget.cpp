@@ -872,7 +872,7 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int index, bo
 	if (goodThumb) {
 		sticker->thumb->load();
 	} else {
-		sticker->checkSticker();
+		sticker->automaticLoad(nullptr);
 	}
 
 	auto coef = qMin((_singleSize.width() - st::buttonRadius * 2) / float64(sticker->dimensions.width()), (_singleSize.height() - st::buttonRadius * 2) / float64(sticker->dimensions.height()));
@@ -890,8 +890,13 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int index, bo
 	};
 	if (goodThumb) {
 		paintImage(sticker->thumb);
-	} else if (!sticker->sticker()->img->isNull()) {
-		paintImage(sticker->sticker()->img);
+	} else {
+		const auto pixmap = Auth().data().stickersDecoder().panelPixmap(
+			sticker,
+			QSize(w, h));
+		if (!pixmap.isNull()) {
+			p.drawPixmapLeft(ppos, width(), pixmap);
+		}
 	}
 
 	if (selected && stickerHasDeleteButton(set, index)) {
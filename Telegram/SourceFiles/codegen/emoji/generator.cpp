@@ -7,6 +7,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "codegen/emoji/generator.h"
 
+#include "ui/emoji_trie.h"
+
 #include <QtCore/QtPlugin>
 #include <QtCore/QBuffer>
 #include <QtGui/QFontDatabase>
@@ -14,6 +16,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
 #include <QtCore/QDir>
+#include <algorithm>
+#include <deque>
+#include <limits>
 
 #ifdef SUPPORT_IMAGE_GENERATION
 Q_IMPORT_PLUGIN(QWebpPlugin)
@@ -28,6 +33,14 @@ Q_IMPORT_PLUGIN(QXcbIntegrationPlugin)
 
 namespace codegen {
 namespace emoji {
+
+struct TrieNode {
+	ushort ch = 0;
+	int value = 0;
+	int childrenStart = 0;
+	int childrenCount = 0;
+};
+
 namespace {
 
 constexpr auto kErrorCantWritePath = 851;
@@ -149,6 +162,53 @@ uint32 countCrc32(const void *data, std::size_t size) {
 	return (result ^ 0xFFFFFFFFU);
 }
 
+// Every node children are stored contiguously sorted by code unit and
+// the nodes are laid out breadth-first, so that the upper levels that
+// are checked for every character of the text share the cache lines.
+std::vector<TrieNode> BuildTrie(const std::map<QString, int, std::greater<QString>> &dictionary) {
+	struct BuildNode {
+		int value = 0;
+		std::map<ushort, int> children;
+	};
+	auto nodes = std::vector<BuildNode>(1);
+	for (auto &item : dictionary) {
+		auto index = 0;
+		for (auto ch : item.first) {
+			auto i = nodes[index].children.find(ch.unicode());
+			if (i == nodes[index].children.cend()) {
+				nodes.push_back(BuildNode());
+				i = nodes[index].children.emplace(ch.unicode(), int(nodes.size()) - 1).first;
+			}
+			index = i->second;
+		}
+		nodes[index].value = item.second + 1;
+	}
+
+	auto result = std::vector<TrieNode>(1);
+	auto queue = std::deque<std::pair<int, int>>(1, std::make_pair(0, 0));
+	while (!queue.empty()) {
+		auto from = queue.front().first;
+		auto to = queue.front().second;
+		queue.pop_front();
+
+		result[to].childrenStart = int(result.size());
+		result[to].childrenCount = int(nodes[from].children.size());
+		for (auto &child : nodes[from].children) {
+			auto node = TrieNode();
+			node.ch = child.first;
+			node.value = nodes[child.second].value;
+			queue.push_back(std::make_pair(child.second, int(result.size())));
+			result.push_back(node);
+		}
+	}
+	return result;
+}
+
+int FindInTrie(const std::vector<TrieNode> &trie, const QString &text, bool skipPostfixes, int *outLength) {
+	const auto start = text.constData();
+	return Ui::Emoji::FindInTrie(trie.data(), start, start + text.size(), outLength, skipPostfixes);
+}
+
 } // namespace
 
 Generator::Generator(const Options &options) : project_(Project)
@@ -305,7 +365,8 @@ bool Generator::writeImages() {
 bool Generator::writeSource() {
 	source_ = std::make_unique<common::CppFile>(outputPath_ + ".cpp", project_);
 
-	source_->include("emoji_suggestions_data.h").newline();
+	source_->include("emoji_suggestions_data.h");
+	source_->include("ui/emoji_trie.h").newline();
 	source_->pushNamespace("Ui").pushNamespace("Emoji").pushNamespace();
 	source_->stream() << "\
 \n\
@@ -317,6 +378,9 @@ std::vector<One> Items;\n\
 	if (!writeSections()) {
 		return false;
 	}
+	if (!writeTrieNode()) {
+		return false;
+	}
 	if (!writeFindReplace()) {
 		return false;
 	}
@@ -588,158 +652,85 @@ EmojiPack GetSection(Section section) {\n\
 	return true;
 }
 
-bool Generator::writeFindReplace() {
+bool Generator::writeTrieNode() {
 	source_->stream() << "\
 \n\
-int FindReplaceIndex(const QChar *start, const QChar *end, int *outLength) {\n\
-	auto ch = start;\n\
-\n";
+struct TrieNode {\n\
+	ushort ch;\n\
+	ushort value;\n\
+	ushort childrenStart;\n\
+	ushort childrenCount;\n\
+};\n";
+	return true;
+}
 
-	if (!writeFindFromDictionary(data_.replaces)) {
+bool Generator::writeFindReplace() {
+	auto trie = BuildTrie(data_.replaces);
+	for (auto &item : data_.replaces) {
+		auto length = 0;
+		if (FindInTrie(trie, item.first, false, &length) != item.second + 1 || length != item.first.size()) {
+			logDataError() << "replace not found in trie: " << item.first.toStdString();
+			return false;
+		}
+	}
+	if (!writeTrie("ReplaceTrie", trie)) {
 		return false;
 	}
 
 	source_->stream() << "\
+\n\
+int FindReplaceIndex(const QChar *start, const QChar *end, int *outLength) {\n\
+	return FindInTrie(ReplaceTrie, start, end, outLength, false);\n\
 }\n";
 
 	return true;
 }
 
 bool Generator::writeFind() {
-	source_->stream() << "\
-\n\
-int FindIndex(const QChar *start, const QChar *end, int *outLength) {\n\
-	auto ch = start;\n\
-\n";
-
-	if (!writeFindFromDictionary(data_.map, true)) {
+	// Every emoji must be found by its id with or without the postfixes.
+	auto trie = BuildTrie(data_.map);
+	auto index = 0;
+	for (auto &item : data_.list) {
+		auto text = item.postfixed ? (item.id + QChar(kPostfix)) : item.id;
+		auto length = 0;
+		if (FindInTrie(trie, text, true, &length) != index + 1 || length != text.size()) {
+			logDataError() << "emoji not found in trie: " << item.id.toStdString();
+			return false;
+		}
+		++index;
+	}
+	if (!writeTrie("FindTrie", trie)) {
 		return false;
 	}
 
 	source_->stream() << "\
+\n\
+int FindIndex(const QChar *start, const QChar *end, int *outLength) {\n\
+	return FindInTrie(FindTrie, start, end, outLength, true);\n\
 }\n\
 \n";
 
 	return true;
 }
 
-bool Generator::writeFindFromDictionary(const std::map<QString, int, std::greater<QString>> &dictionary, bool skipPostfixes) {
-	auto tabs = [](int size) {
-		return QString(size, '\t');
-	};
-
-	std::map<int, int> uniqueFirstChars;
-	auto foundMax = 0, foundMin = 65535;
-	for (auto &item : dictionary) {
-		auto ch = item.first[0].unicode();
-		if (foundMax < ch) foundMax = ch;
-		if (foundMin > ch) foundMin = ch;
-		uniqueFirstChars[ch] = 0;
-	}
-
-	enum class UsedCheckType {
-		Switch,
-		If,
-	};
-	auto checkTypes = QVector<UsedCheckType>();
-	auto chars = QString();
-	auto tabsUsed = 1;
-	auto lengthsCounted = std::map<QString, bool>();
-
-	auto writeSkipPostfix = [this, &tabs, skipPostfixes](int tabsCount) {
-		if (skipPostfixes) {
-			source_->stream() << tabs(tabsCount) << "if (++ch != end && ch->unicode() == kPostfix) ++ch;\n";
-		} else {
-			source_->stream() << tabs(tabsCount) << "++ch;\n";
-		}
-	};
-
-	// Returns true if at least one check was finished.
-	auto finishChecksTillKey = [this, &chars, &checkTypes, &tabsUsed, tabs](const QString &key) {
-		auto result = false;
-		while (!chars.isEmpty() && key.midRef(0, chars.size()) != chars) {
-			result = true;
-
-			auto wasType = checkTypes.back();
-			chars.resize(chars.size() - 1);
-			checkTypes.pop_back();
-			if (wasType == UsedCheckType::Switch || wasType == UsedCheckType::If) {
-				--tabsUsed;
-				if (wasType == UsedCheckType::Switch) {
-					source_->stream() << tabs(tabsUsed) << "break;\n";
-				}
-				if ((!chars.isEmpty() && key.midRef(0, chars.size()) != chars) || key == chars) {
-					source_->stream() << tabs(tabsUsed) << "}\n";
-				}
-			}
-		}
-		return result;
-	};
-
-	// Check if we can use "if" for a check on "charIndex" in "it" (otherwise only "switch")
-	auto canUseIfForCheck = [](auto it, auto end, int charIndex) {
-		auto key = it->first;
-		auto i = it;
-		auto keyStart = key.mid(0, charIndex);
-		for (++i; i != end; ++i) {
-			auto nextKey = i->first;
-			if (nextKey.mid(0, charIndex) != keyStart) {
-				return true;
-			} else if (nextKey.size() > charIndex && nextKey[charIndex] != key[charIndex]) {
-				return false;
-			}
-		}
-		return true;
-	};
-
-	for (auto i = dictionary.cbegin(), e = dictionary.cend(); i != e; ++i) {
-		auto &item = *i;
-		auto key = item.first;
-		auto weContinueOldSwitch = finishChecksTillKey(key);
-		while (chars.size() != key.size()) {
-			auto checking = chars.size();
-			auto partialKey = key.mid(0, checking);
-			if (dictionary.find(partialKey) != dictionary.cend()) {
-				if (lengthsCounted.find(partialKey) == lengthsCounted.cend()) {
-					lengthsCounted.insert(std::make_pair(partialKey, true));
-					source_->stream() << tabs(tabsUsed) << "if (outLength) *outLength = (ch - start);\n";
-				}
-			}
-
-			auto keyChar = key[checking];
-			auto keyCharString = "0x" + QString::number(keyChar.unicode(), 16);
-			auto usedIfForCheck = !weContinueOldSwitch && canUseIfForCheck(i, e, checking);
-			if (weContinueOldSwitch) {
-				weContinueOldSwitch = false;
-			} else if (!usedIfForCheck) {
-				source_->stream() << tabs(tabsUsed) << "if (ch != end) switch (ch->unicode()) {\n";
-			}
-			if (usedIfForCheck) {
-				source_->stream() << tabs(tabsUsed) << "if (ch != end && ch->unicode() == " << keyCharString << ") {\n";
-				checkTypes.push_back(UsedCheckType::If);
-			} else {
-				source_->stream() << tabs(tabsUsed) << "case " << keyCharString << ":\n";
-				checkTypes.push_back(UsedCheckType::Switch);
-			}
-			writeSkipPostfix(++tabsUsed);
-			chars.push_back(keyChar);
-		}
-		if (lengthsCounted.find(key) == lengthsCounted.cend()) {
-			lengthsCounted.insert(std::make_pair(key, true));
-			source_->stream() << tabs(tabsUsed) << "if (outLength) *outLength = (ch - start);\n";
-		}
-
-		// While IsReplaceEdge() currently is always true we just return the value.
-		//source_->stream() << tabs(1 + chars.size()) << "if (ch + " << chars.size() << " == end || IsReplaceEdge(*(ch + " << chars.size() << ")) || (ch + " << chars.size() << ")->unicode() == ' ') {\n";
-		//source_->stream() << tabs(1 + chars.size()) << "\treturn &Items[" << item.second << "];\n";
-		//source_->stream() << tabs(1 + chars.size()) << "}\n";
-		source_->stream() << tabs(tabsUsed) << "return " << (item.second + 1) << ";\n";
+bool Generator::writeTrie(const QString &name, const std::vector<TrieNode> &trie) {
+	if (trie.size() >= std::numeric_limits<ushort>::max()) {
+		logDataError() << "Too many trie nodes.";
+		return false;
 	}
-	finishChecksTillKey(QString());
-
 	source_->stream() << "\
 \n\
-	return 0;\n";
+const TrieNode " << name << "[] = {";
+	auto count = 0;
+	for (auto &node : trie) {
+		if (node.value >= std::numeric_limits<ushort>::max()) {
+			logDataError() << "Too large trie value.";
+			return false;
+		}
+		source_->stream() << (count++ % 4 ? " " : "\n\t") << "{ 0x" << QString::number(node.ch, 16) << ", " << node.value << ", " << node.childrenStart << ", " << node.childrenCount << " },";
+	}
+	source_->stream() << "\n\
+};\n";
 	return true;
 }
 
@@ -20,6 +20,8 @@ namespace emoji {
 
 using uint32 = unsigned int;
 
+struct TrieNode;
+
 class Generator {
 public:
 	Generator(const Options &options);
@@ -46,9 +48,10 @@ private:
 	bool writeSections();
 	bool writeReplacements();
 	bool writeGetSections();
+	bool writeTrieNode();
 	bool writeFindReplace();
 	bool writeFind();
-	bool writeFindFromDictionary(const std::map<QString, int, std::greater<QString>> &dictionary, bool skipPostfixes = false);
+	bool writeTrie(const QString &name, const std::vector<TrieNode> &trie);
 	bool writeGetReplacements();
 	void startBinary();
 	bool writeStringBinary(common::CppFile *source, const QString &string);
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "platform/platform_launcher.h"
 #include "platform/platform_specific.h"
 #include "core/crash_reports.h"
+#include "core/startup_trace.h"
 #include "core/main_queue_processor.h"
 #include "application.h"
 
@@ -176,6 +177,7 @@ void Launcher::processArguments() {
 		{ "-startintray", KeyFormat::NoValues },
 		{ "-sendpath"   , KeyFormat::AllLeftValues },
 		{ "-workdir"    , KeyFormat::OneValue },
+		{ "-tracestartup", KeyFormat::NoValues },
 		{ "--"          , KeyFormat::OneValue },
 	};
 	auto parseResult = QMap<QByteArray, QStringList>();
@@ -222,6 +224,10 @@ void Launcher::processArguments() {
 		}
 	}
 	gStartUrl = parseResult.value("--", QStringList()).join(QString());
+
+	if (parseResult.contains("-tracestartup")) {
+		StartupTrace::Start();
+	}
 }
 
 int Launcher::executeApplication() {
@@ -0,0 +1,152 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/startup_trace.h"
+
+#include <atomic>
+
+namespace StartupTrace {
+namespace {
+
+struct Event {
+	const char *name = nullptr;
+	Qt::HANDLE thread = nullptr;
+	int64 start = 0;
+	int64 duration = 0;
+	int64 bytesRead = 0;
+};
+
+struct Data {
+	QElapsedTimer timer;
+	QMutex mutex;
+	std::vector<Event> events;
+	std::map<Qt::HANDLE, Span*> current;
+};
+
+std::atomic<bool> Recording(false);
+Data *Instance = nullptr;
+
+int64 Now() {
+	return Instance->timer.nsecsElapsed() / 1000;
+}
+
+QString TracePath() {
+	return cWorkingDir() + qsl("DebugLogs/startup_trace.json");
+}
+
+QByteArray Serialize(const std::vector<Event> &events) {
+	const auto pid = QCoreApplication::applicationPid();
+	auto threads = std::map<Qt::HANDLE, int>();
+	auto list = QJsonArray();
+	for (const auto &event : events) {
+		// Chrome trace viewer expects small integer thread ids.
+		const auto tid = threads.emplace(
+			event.thread,
+			int(threads.size()) + 1).first->second;
+		auto args = QJsonObject();
+		if (event.bytesRead > 0) {
+			args.insert(qsl("bytes_read"), double(event.bytesRead));
+		}
+		auto object = QJsonObject();
+		object.insert(qsl("name"), QString::fromLatin1(event.name));
+		object.insert(qsl("cat"), qsl("startup"));
+		object.insert(qsl("ph"), qsl("X"));
+		object.insert(qsl("ts"), double(event.start));
+		object.insert(qsl("dur"), double(event.duration));
+		object.insert(qsl("pid"), double(pid));
+		object.insert(qsl("tid"), tid);
+		object.insert(qsl("args"), args);
+		list.append(object);
+	}
+	auto result = QJsonObject();
+	result.insert(qsl("traceEvents"), list);
+	result.insert(qsl("displayTimeUnit"), qsl("ms"));
+	return QJsonDocument(result).toJson(QJsonDocument::Compact);
+}
+
+} // namespace
+
+void Start() {
+	if (Instance) {
+		return;
+	}
+	Instance = new Data();
+	Instance->timer.start();
+	Recording = true;
+}
+
+void Finish() {
+	if (!Recording.exchange(false)) {
+		return;
+	}
+	auto events = [&] {
+		QMutexLocker lock(&Instance->mutex);
+		return base::take(Instance->events);
+	}();
+
+	// Spans still open on other threads may finish later,
+	// so the instance itself is never destroyed.
+	const auto path = TracePath();
+	QDir().mkpath(QFileInfo(path).absolutePath());
+	QFile f(path);
+	if (!f.open(QIODevice::WriteOnly)) {
+		LOG(("App Error: could not open '%1' for writing startup trace."
+			).arg(path));
+		return;
+	}
+	f.write(Serialize(events));
+	LOG(("App Info: startup trace with %1 spans written to '%2'."
+		).arg(events.size()
+		).arg(path));
+}
+
+void AddBytesRead(int64 bytes) {
+	if (!Recording) {
+		return;
+	}
+	QMutexLocker lock(&Instance->mutex);
+	const auto i = Instance->current.find(QThread::currentThreadId());
+	if (i != Instance->current.end()) {
+		i->second->addBytesRead(bytes);
+	}
+}
+
+Span::Span(const char *name) : _name(name) {
+	if (!Recording) {
+		return;
+	}
+	QMutexLocker lock(&Instance->mutex);
+	auto &current = Instance->current[QThread::currentThreadId()];
+	_parent = current;
+	current = this;
+	_start = Now();
+}
+
+Span::~Span() {
+	if (_start < 0) {
+		return;
+	}
+	QMutexLocker lock(&Instance->mutex);
+	const auto thread = QThread::currentThreadId();
+	if (_parent) {
+		_parent->addBytesRead(_bytesRead);
+		Instance->current[thread] = _parent;
+	} else {
+		Instance->current.erase(thread);
+	}
+	if (Recording) {
+		auto event = Event();
+		event.name = _name;
+		event.thread = thread;
+		event.start = _start;
+		event.duration = Now() - _start;
+		event.bytesRead = _bytesRead;
+		Instance->events.push_back(event);
+	}
+}
+
+} // namespace StartupTrace
@@ -0,0 +1,43 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace StartupTrace {
+
+// When the app is launched with -tracestartup the startup phases are
+// recorded as spans and written to DebugLogs/startup_trace.json in the
+// Chrome trace event format, it can be opened in chrome://tracing.
+void Start();
+
+// Writes the collected spans and stops recording, does nothing
+// if the trace was not started or was already finished.
+void Finish();
+
+// Adds bytes read from disk to the innermost span of the current thread.
+void AddBytesRead(int64 bytes);
+
+class Span {
+public:
+	explicit Span(const char *name);
+	Span(const Span &other) = delete;
+	Span &operator=(const Span &other) = delete;
+	~Span();
+
+	void addBytesRead(int64 bytes) {
+		_bytesRead += bytes;
+	}
+
+private:
+	const char *_name = nullptr;
+	Span *_parent = nullptr;
+	int64 _start = -1;
+	int64 _bytesRead = 0;
+
+};
+
+} // namespace StartupTrace
@@ -266,25 +266,25 @@ using TimeMs = int64;
 bool checkms(); // returns true if time has changed
 TimeMs getms(bool checked = false);
 
-const static uint32 _md5_block_size = 64;
+// Streaming MD5 over the OpenSSL implementation, which uses the assembly
+// code paths available for the running CPU. The OpenSSL context is kept
+// in utils.cpp, so that its headers are not included everywhere.
 class HashMd5 {
 public:
+	HashMd5(const void *input = nullptr, uint32 length = 0);
+	HashMd5(HashMd5 &&other);
+	HashMd5 &operator=(HashMd5 &&other);
+	~HashMd5();
 
-	HashMd5(const void *input = 0, uint32 length = 0);
 	void feed(const void *input, uint32 length);
 	int32 *result();
 
 private:
+	struct Context;
 
-	void init();
-	void finalize();
-	void transform(const uchar *block);
-
-	bool _finalized;
-	uchar _buffer[_md5_block_size];
-	uint32 _count[2];
-	uint32 _state[4];
+	std::unique_ptr<Context> _context;
 	uchar _digest[16];
+	bool _finalized = false;
 
 };
 
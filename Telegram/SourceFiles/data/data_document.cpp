@@ -373,7 +373,7 @@ VoiceData::~VoiceData() {
 	if (!waveform.isEmpty() && waveform.at(0) == -1 && waveform.size() > int32(sizeof(TaskId))) {
 		TaskId taskId = 0;
 		memcpy(&taskId, waveform.constData() + 1, sizeof(taskId));
-		Local::cancelTask(taskId);
+		Local::cancelVoiceWaveform(taskId);
 	}
 }
 
@@ -622,6 +622,34 @@ void DocumentData::performActionOnLoad() {
 	_actionOnLoad = ActionOnLoadNone;
 }
 
+void DocumentData::checkSticker() {
+	const auto sticker = this->sticker();
+	if (!sticker) return;
+
+	automaticLoad(nullptr);
+	if (sticker->img->isNull() && loaded()) {
+		Auth().data().stickersDecoder().requestImage(this);
+	}
+}
+
+void DocumentData::checkStickerNow() {
+	const auto sticker = this->sticker();
+	if (!sticker) return;
+
+	automaticLoad(nullptr);
+	if (sticker->img->isNull() && loaded()) {
+		if (_data.isEmpty()) {
+			const auto &loc = location(true);
+			if (loc.accessEnable()) {
+				sticker->img = ImagePtr(loc.name());
+				loc.accessDisable();
+			}
+		} else {
+			sticker->img = ImagePtr(_data);
+		}
+	}
+}
+
 bool DocumentData::loaded(FilePathResolveType type) const {
 	if (loading() && _loader->finished()) {
 		if (_loader->cancelled()) {
@@ -630,8 +658,8 @@ bool DocumentData::loaded(FilePathResolveType type) const {
 			auto that = const_cast<DocumentData*>(this);
 			that->_location = FileLocation(_loader->fileName());
 			that->_data = _loader->bytes();
-			if (that->sticker() && !_loader->imagePixmap().isNull()) {
-				that->sticker()->img = ImagePtr(_data, _loader->imageFormat(), _loader->imagePixmap());
+			if (that->sticker()) {
+				Auth().data().stickersDecoder().documentReloaded(that);
 			}
 			destroyLoaderDelayed();
 		}
@@ -135,23 +135,14 @@ public:
 			? static_cast<StickerData*>(_additional.get())
 			: nullptr;
 	}
-	void checkSticker() {
-		StickerData *s = sticker();
-		if (!s) return;
-
-		automaticLoad(nullptr);
-		if (s->img->isNull() && loaded()) {
-			if (_data.isEmpty()) {
-				const FileLocation &loc(location(true));
-				if (loc.accessEnable()) {
-					s->img = ImagePtr(loc.name());
-					loc.accessDisable();
-				}
-			} else {
-				s->img = ImagePtr(_data);
-			}
-		}
-	}
+
+	// Decodes the sticker image in background, it is put to sticker()->img
+	// and Auth().downloaderTaskFinished() is notified when it is ready.
+	void checkSticker();
+
+	// Decodes the sticker image right away, for the single big previews.
+	void checkStickerNow();
+
 	SongData *song() {
 		return isSong()
 			? static_cast<SongData*>(_additional.get())
@@ -0,0 +1,153 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_search_index.h"
+
+#include "history/history.h"
+#include "history/history_item.h"
+#include "ui/text/text_entity.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kCompactStaleCount = 4096;
+
+} // namespace
+
+void SearchIndex::add(not_null<HistoryItem*> item) {
+	_pending.emplace(item, item);
+}
+
+void SearchIndex::remove(not_null<const HistoryItem*> item) {
+	_pending.remove(item);
+	if (const auto entry = _entries.take(item)) {
+		_staleCount += entry->words.size();
+		compactIfNeeded();
+	}
+}
+
+std::vector<not_null<HistoryItem*>> SearchIndex::search(
+		const QStringList &words,
+		PeerData *inPeer,
+		PeerData *from,
+		int limit) {
+	if (words.isEmpty()) {
+		return {};
+	}
+	indexPending();
+
+	auto found = collect(words[0]);
+	for (auto i = 1; i != words.size() && !found.empty(); ++i) {
+		const auto other = collect(words[i]);
+		auto both = std::vector<HistoryItem*>();
+		std::set_intersection(
+			found.begin(),
+			found.end(),
+			other.begin(),
+			other.end(),
+			std::back_inserter(both));
+		found = std::move(both);
+	}
+
+	const auto migrated = inPeer ? inPeer->migrateFrom() : nullptr;
+	auto result = std::vector<not_null<HistoryItem*>>();
+	result.reserve(found.size());
+	for (const auto item : found) {
+		const auto peer = item->history()->peer;
+		if (inPeer && peer != inPeer && peer != migrated) {
+			continue;
+		} else if (from && item->from() != from) {
+			continue;
+		}
+		result.push_back(item);
+	}
+	ranges::sort(result, [](not_null<HistoryItem*> a, not_null<HistoryItem*> b) {
+		return (a->date > b->date)
+			|| (a->date == b->date && a->id > b->id);
+	});
+	if (limit > 0 && int(result.size()) > limit) {
+		result.erase(result.begin() + limit, result.end());
+	}
+	return result;
+}
+
+void SearchIndex::indexPending() {
+	for (const auto &[key, item] : base::take(_pending)) {
+		index(item);
+	}
+}
+
+void SearchIndex::index(not_null<HistoryItem*> item) {
+	auto words = TextUtilities::PrepareSearchWords(
+		item->originalText().text);
+	words.removeDuplicates();
+
+	auto &entry = _entries[item];
+	_staleCount += entry.words.size();
+	if (words.isEmpty()) {
+		_entries.remove(item);
+		compactIfNeeded();
+		return;
+	}
+	entry.item = item;
+	entry.generation = ++_generation;
+	entry.words = std::move(words);
+	for (const auto &word : entry.words) {
+		_postings[word].push_back({ entry.item, entry.generation });
+	}
+	_postingsCount += entry.words.size();
+	compactIfNeeded();
+}
+
+void SearchIndex::compactIfNeeded() {
+	if (_staleCount < kCompactStaleCount
+		|| _staleCount * 2 < _postingsCount) {
+		return;
+	}
+	for (auto i = _postings.begin(); i != _postings.end();) {
+		auto &list = i->second;
+		list.erase(
+			ranges::remove_if(list, [&](const Posting &posting) {
+				return !valid(posting);
+			}),
+			list.end());
+		if (list.empty()) {
+			i = _postings.erase(i);
+		} else {
+			++i;
+		}
+	}
+	_postingsCount -= _staleCount;
+	_staleCount = 0;
+}
+
+bool SearchIndex::valid(const Posting &posting) const {
+	const auto i = _entries.find(posting.item);
+	return (i != _entries.end())
+		&& (i->second.generation == posting.generation);
+}
+
+std::vector<HistoryItem*> SearchIndex::collect(
+		const QString &prefix) const {
+	auto result = std::vector<HistoryItem*>();
+	const auto till = _postings.end();
+	for (auto i = _postings.lower_bound(prefix); i != till; ++i) {
+		if (!i->first.startsWith(prefix)) {
+			break;
+		}
+		for (const auto &posting : i->second) {
+			if (valid(posting)) {
+				result.push_back(posting.item);
+			}
+		}
+	}
+	ranges::sort(result);
+	result.erase(ranges::unique(result), result.end());
+	return result;
+}
+
+} // namespace Data
@@ -0,0 +1,59 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/flat_hash_map.h"
+
+namespace Data {
+
+// Inverted index of the words of the messages loaded in histories.
+//
+// Items are only queued when they are added or edited and are split to
+// words when the index is queried, so loading history doesn't pay for it.
+// Removed items leave stale postings that are skipped while searching
+// and dropped all at once when there are enough of them.
+class SearchIndex {
+public:
+	void add(not_null<HistoryItem*> item);
+	void remove(not_null<const HistoryItem*> item);
+
+	// Items having words starting with each of the query words
+	// (prepared by TextUtilities::PrepareSearchWords), newest first.
+	std::vector<not_null<HistoryItem*>> search(
+		const QStringList &words,
+		PeerData *inPeer,
+		PeerData *from,
+		int limit);
+
+private:
+	struct Entry {
+		HistoryItem *item = nullptr;
+		int generation = 0;
+		QStringList words;
+	};
+	struct Posting {
+		HistoryItem *item = nullptr;
+		int generation = 0;
+	};
+
+	void indexPending();
+	void index(not_null<HistoryItem*> item);
+	void compactIfNeeded();
+	bool valid(const Posting &posting) const;
+	std::vector<HistoryItem*> collect(const QString &prefix) const;
+
+	base::flat_hash_map<const HistoryItem*, HistoryItem*> _pending;
+	base::flat_hash_map<const HistoryItem*, Entry> _entries;
+	std::map<QString, std::vector<Posting>> _postings;
+	int _generation = 0;
+	int _postingsCount = 0;
+	int _staleCount = 0;
+
+};
+
+} // namespace Data
@@ -94,6 +94,11 @@ DialogsInner::DialogsInner(QWidget *parent, not_null<Window::Controller*> contro
 			item->history()->updateChatListEntry();
 		}
 	}, lifetime());
+	subscribe(Auth().data().queryItemsInUse(), [this](const AuthSessionData::ItemsInUseQuery &query) {
+		for (const auto &result : _searchResults) {
+			query.items->emplace(result->item());
+		}
+	});
 	subscribe(App::histories().sendActionAnimationUpdated(), [this](const Histories::SendActionAnimationUpdate &update) {
 		auto updateRect = Dialogs::Layout::RowPainter::sendActionAnimationRect(update.width, update.height, getFullWidth(), update.textUpdated);
 		updateDialogRow(update.history->peer, MsgId(0), updateRect, UpdateRowSection::Default | UpdateRowSection::Filtered);
@@ -1314,6 +1319,7 @@ void DialogsInner::onFilterUpdate(QString newFilter, bool force) {
 		: TextUtilities::PrepareSearchWords(newFilter);
 	newFilter = words.isEmpty() ? QString() : words.join(' ');
 	if (newFilter != _filter || force) {
+		const auto changed = (newFilter != _filter);
 		_filter = newFilter;
 		if (_filter.isEmpty() && !_searchFromUser) {
 			clearFilter();
@@ -1391,6 +1397,9 @@ void DialogsInner::onFilterUpdate(QString newFilter, bool force) {
 					}
 				}
 			}
+			if (changed && !mentionsSearch && !words.isEmpty()) {
+				searchLocal(words);
+			}
 			refresh(true);
 		}
 		setMouseSelection(false, true);
@@ -1436,6 +1445,7 @@ DialogsInner::~DialogsInner() {
 void DialogsInner::clearSearchResults(bool clearPeerSearchResults) {
 	if (clearPeerSearchResults) _peerSearchResults.clear();
 	_searchResults.clear();
+	_searchLocalResults.clear();
 	_searchedCount = _searchedMigratedCount = 0;
 	_lastSearchDate = 0;
 	_lastSearchPeer = 0;
@@ -1473,6 +1483,11 @@ void DialogsInner::visibleTopBottomUpdated(
 }
 
 void DialogsInner::itemRemoved(not_null<const HistoryItem*> item) {
+	_searchLocalResults.erase(
+		ranges::remove_if(_searchLocalResults, [&](not_null<HistoryItem*> local) {
+			return (local.get() == item.get());
+		}),
+		_searchLocalResults.end());
 	int wasCount = _searchResults.size();
 	for (auto i = _searchResults.begin(); i != _searchResults.end();) {
 		if ((*i)->item() == item) {
@@ -1558,7 +1573,9 @@ void DialogsInner::addAllSavedPeers() {
 
 bool DialogsInner::searchReceived(const QVector<MTPMessage> &messages, DialogsSearchRequestType type, int32 fullCount) {
 	if (type == DialogsSearchFromStart || type == DialogsSearchPeerFromStart) {
+		auto local = base::take(_searchLocalResults);
 		clearSearchResults(false);
+		_searchLocalResults = std::move(local);
 	}
 	auto isGlobalSearch = (type == DialogsSearchFromStart || type == DialogsSearchFromOffset);
 	auto isMigratedSearch = (type == DialogsSearchMigratedFromStart || type == DialogsSearchMigratedFromOffset);
@@ -1571,7 +1588,9 @@ bool DialogsInner::searchReceived(const QVector<MTPMessage> &messages, DialogsSe
 		if (auto peer = App::peerLoaded(peerId)) {
 			if (lastDate) {
 				auto item = App::histories().addNewMessage(message, NewMessageExisting);
-				_searchResults.push_back(std::make_unique<Dialogs::FakeRow>(_searchInPeer, item));
+				if (!searchResultShown(item)) {
+					_searchResults.push_back(std::make_unique<Dialogs::FakeRow>(_searchInPeer, item));
+				}
 				lastDateFound = lastDate;
 				if (isGlobalSearch) {
 					_lastSearchDate = lastDateFound;
@@ -1593,6 +1612,9 @@ bool DialogsInner::searchReceived(const QVector<MTPMessage> &messages, DialogsSe
 		_searchedMigratedCount = fullCount;
 	} else {
 		_searchedCount = fullCount;
+
+		// Local results older than the received page wait for the next one.
+		mergeLocalResults(lastDateFound);
 	}
 	if (_state == FilteredState && (!_searchResults.empty() || !_searchInMigrated || type == DialogsSearchMigratedFromStart || type == DialogsSearchMigratedFromOffset)) {
 		_state = SearchedState;
@@ -1601,6 +1623,48 @@ bool DialogsInner::searchReceived(const QVector<MTPMessage> &messages, DialogsSe
 	return lastDateFound != 0;
 }
 
+void DialogsInner::searchLocal(const QStringList &words) {
+	clearSearchResults(false);
+	_searchLocalResults = Auth().data().searchIndex().search(
+		words,
+		_searchInPeer,
+		_searchFromUser,
+		SearchPerPage);
+	for (const auto item : _searchLocalResults) {
+		_searchResults.push_back(std::make_unique<Dialogs::FakeRow>(_searchInPeer, item));
+	}
+	_searchedCount = _searchResults.size();
+}
+
+void DialogsInner::mergeLocalResults(TimeId till) {
+	auto merged = false;
+	for (auto i = _searchLocalResults.begin(); i != _searchLocalResults.end();) {
+		const auto item = *i;
+		if (till && TimeId(item->date.toTime_t()) < till) {
+			++i;
+			continue;
+		}
+		i = _searchLocalResults.erase(i);
+		if (!searchResultShown(item)) {
+			_searchResults.push_back(std::make_unique<Dialogs::FakeRow>(_searchInPeer, item));
+			merged = true;
+		}
+	}
+	if (merged) {
+		ranges::stable_sort(_searchResults, [](const auto &a, const auto &b) {
+			return (a->item()->date > b->item()->date);
+		});
+		accumulate_max(_searchedCount, int(_searchResults.size()) - _searchedMigratedCount);
+	}
+}
+
+bool DialogsInner::searchResultShown(not_null<HistoryItem*> item) const {
+	return ranges::find(
+		_searchResults,
+		item,
+		[](const auto &row) { return row->item(); }) != _searchResults.end();
+}
+
 void DialogsInner::peerSearchReceived(const QString &query, const QVector<MTPPeer> &result) {
 	_peerSearchQuery = query.toLower().trimmed();
 	_peerSearchResults.clear();
@@ -1818,6 +1882,7 @@ void DialogsInner::clearFilter() {
 		_filterResults.clear();
 		_peerSearchResults.clear();
 		_searchResults.clear();
+		_searchLocalResults.clear();
 		_lastSearchDate = 0;
 		_lastSearchPeer = 0;
 		_lastSearchId = _lastSearchMigratedId = 0;
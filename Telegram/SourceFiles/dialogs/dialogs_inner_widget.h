@@ -192,6 +192,9 @@ private:
 
 	void clearSelection();
 	void clearSearchResults(bool clearPeerSearchResults = true);
+	void searchLocal(const QStringList &words);
+	void mergeLocalResults(TimeId till);
+	bool searchResultShown(not_null<HistoryItem*> item) const;
 	void updateSelectedRow(PeerData *peer = 0);
 
 	Dialogs::IndexedList *shownDialogs() const {
@@ -261,6 +264,7 @@ private:
 	int _peerSearchPressed = -1;
 
 	SearchResults _searchResults;
+	std::vector<not_null<HistoryItem*>> _searchLocalResults;
 	int _searchedCount = 0;
 	int _searchedMigratedCount = 0;
 	int _searchedSelected = -1;
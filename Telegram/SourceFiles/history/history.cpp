@@ -28,6 +28,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_channel_admins.h"
 #include "ui/text_options.h"
 #include "core/crash_reports.h"
+#include "window/window_controller.h"
+#include "media/player/media_player_instance.h"
 
 namespace {
 
@@ -45,6 +47,9 @@ constexpr auto kStatusShowClientsideChooseContact = 6000;
 constexpr auto kStatusShowClientsidePlayGame = 10000;
 constexpr auto kSetMyActionForMs = 10000;
 constexpr auto kNewBlockEachMessage = 50;
+constexpr auto kUnloadCheckTimeout = 5 * 60 * TimeMs(1000);
+constexpr auto kUnloadInactiveTimeout = 60 * 60 * TimeMs(1000);
+constexpr auto kLoadedMessagesLimit = 50000;
 
 auto GlobalPinnedIndex = 0;
 
@@ -556,6 +561,9 @@ not_null<History*> Histories::findOrInsert(const PeerId &peerId) {
 	if (i == map.cend()) {
 		auto history = peerIsChannel(peerId) ? static_cast<History*>(new ChannelHistory(peerId)) : (new History(peerId));
 		i = map.insert(peerId, history);
+		if (!_unloadTimer.isActive()) {
+			_unloadTimer.callEach(kUnloadCheckTimeout);
+		}
 	}
 	return i.value();
 }
@@ -565,6 +573,9 @@ not_null<History*> Histories::findOrInsert(const PeerId &peerId, int32 unreadCou
 	if (i == map.cend()) {
 		auto history = peerIsChannel(peerId) ? static_cast<History*>(new ChannelHistory(peerId)) : (new History(peerId));
 		i = map.insert(peerId, history);
+		if (!_unloadTimer.isActive()) {
+			_unloadTimer.callEach(kUnloadCheckTimeout);
+		}
 		history->setUnreadCount(unreadCount);
 		history->inboxReadBefore = maxInboxRead + 1;
 		history->outboxReadBefore = maxOutboxRead + 1;
@@ -583,6 +594,9 @@ void Histories::clear() {
 	App::historyClearMsgs();
 
 	_pinnedDialogs.clear();
+	_unloadTimer.cancel();
+	_chatListSortDelayed.clear();
+	_chatListSortDelayedSet.clear();
 	auto temp = base::take(map);
 	for_const (auto history, temp) {
 		delete history;
@@ -627,11 +641,58 @@ void Histories::remove(const PeerId &peer) {
 	Map::iterator i = map.find(peer);
 	if (i != map.cend()) {
 		typing.remove(i.value());
+		if (_chatListSortDelayedSet.remove(i.value())) {
+			_chatListSortDelayed.erase(
+				ranges::remove(
+					_chatListSortDelayed,
+					i.value(),
+					[](not_null<History*> history) { return history.get(); }),
+				end(_chatListSortDelayed));
+		}
 		delete i.value();
 		map.erase(i);
 	}
 }
 
+Histories::UpdatesBatch::UpdatesBatch() {
+	App::histories().startUpdatesBatch();
+}
+
+Histories::UpdatesBatch::~UpdatesBatch() {
+	App::histories().finishUpdatesBatch();
+}
+
+void Histories::startUpdatesBatch() {
+	++_updatesBatchLevel;
+}
+
+void Histories::finishUpdatesBatch() {
+	Expects(_updatesBatchLevel > 0);
+
+	if (--_updatesBatchLevel) {
+		return;
+	}
+	const auto delayed = base::take(_chatListSortDelayed);
+	_chatListSortDelayedSet.clear();
+	if (!delayed.empty()) {
+		DEBUG_LOG(("Histories Info: updating %1 chat list positions after an updates batch.").arg(int(delayed.size())));
+	}
+	for (const auto history : delayed) {
+		history->updateChatListSortPosition();
+	}
+}
+
+bool Histories::delayChatListSortPosition(not_null<History*> history) {
+	if (!_updatesBatchLevel) {
+		return false;
+	}
+	if (!_chatListSortDelayedSet.contains(history)) {
+		_chatListSortDelayedSet.emplace(history);
+		_chatListSortDelayed.push_back(history);
+	}
+	return true;
+}
+
 namespace {
 
 void checkForSwitchInlineButton(HistoryItem *item) {
@@ -761,6 +822,78 @@ void Histories::checkSelfDestructItems() {
 	}
 }
 
+void Histories::collectItemsInUse(
+		base::flat_set<not_null<HistoryItem*>> &items,
+		base::flat_set<not_null<PeerData*>> &peers) const {
+	const auto window = App::wnd();
+	if (const auto controller = window ? window->controller() : nullptr) {
+		if (const auto peer = controller->historyPeer.current()) {
+			peers.emplace(peer);
+		}
+		if (const auto peer = controller->activePeer.current()) {
+			peers.emplace(peer);
+		}
+	}
+
+	// The playlist of the current track is built from its history.
+	if (const auto player = Media::Player::instance()) {
+		for (const auto type : { AudioMsgId::Type::Voice, AudioMsgId::Type::Song }) {
+			const auto contextId = player->current(type).contextId();
+			if (const auto item = App::histItemById(contextId)) {
+				peers.emplace(item->history()->peer);
+			}
+		}
+	}
+
+	for (const auto history : map) {
+		for (const auto &id : history->forwardDraft()) {
+			if (const auto item = App::histItemById(id)) {
+				items.emplace(item);
+			}
+		}
+	}
+	Auth().data().queryItemsInUse().notify({ &items, &peers }, true);
+}
+
+void Histories::unloadInactive() {
+	const auto limit = kLoadedMessagesLimit;
+	const auto now = getms(true);
+	auto itemsInUse = base::flat_set<not_null<HistoryItem*>>();
+	auto peersInUse = base::flat_set<not_null<PeerData*>>();
+	collectItemsInUse(itemsInUse, peersInUse);
+	const auto used = [&](PeerData *peer) {
+		return peer && peersInUse.contains(peer);
+	};
+	const auto shown = [&](not_null<History*> history) {
+		const auto peer = history->peer;
+		return used(peer)
+			|| used(peer->migrateFrom())
+			|| used(peer->migrateTo());
+	};
+	auto loaded = 0;
+	auto candidates = std::vector<not_null<History*>>();
+	for (const auto history : map) {
+		const auto count = history->loadedItemsCount();
+		loaded += count;
+		if (count > 0
+			&& now - history->lastShownTime() >= kUnloadInactiveTimeout
+			&& !shown(history)) {
+			candidates.push_back(history);
+		}
+	}
+	if (loaded <= limit) {
+		return;
+	}
+	ranges::sort(candidates, ranges::less(), &History::lastShownTime);
+	for (const auto history : candidates) {
+		loaded -= history->loadedItemsCount();
+		history->unloadBlocks(itemsInUse);
+		if (loaded <= limit) {
+			break;
+		}
+	}
+}
+
 HistoryItem *History::createItem(const MTPMessage &msg, bool applyServiceAction, bool detachExistingItem) {
 	const auto msgId = idFromMessage(msg);
 	if (!msgId) return nullptr;
@@ -1421,6 +1554,7 @@ void History::addItemToBlock(not_null<HistoryItem*> item) {
 	item->attachToBlock(block, block->items.size());
 	block->items.push_back(item);
 	item->previousItemChanged();
+	Auth().data().searchIndex().add(item);
 
 	if (isBuildingFrontBlock() && _buildingFrontBlock->expectedItemsCount > 0) {
 		--_buildingFrontBlock->expectedItemsCount;
@@ -2016,6 +2150,7 @@ not_null<HistoryItem*> History::addNewInTheMiddle(not_null<HistoryItem*> newItem
 	newItem->attachToBlock(block, itemIndex);
 	block->items.insert(block->items.begin() + itemIndex, newItem);
 	newItem->previousItemChanged();
+	Auth().data().searchIndex().add(newItem);
 	if (itemIndex + 1 < block->items.size()) {
 		for (int i = itemIndex + 1, l = block->items.size(); i < l; ++i) {
 			block->items[i]->setIndexInBlock(i);
@@ -2303,6 +2438,9 @@ void History::setChatsListDate(const QDateTime &date) {
 }
 
 void History::updateChatListSortPosition() {
+	if (App::histories().delayChatListSortPosition(this)) {
+		return;
+	}
 	auto chatListDate = [this]() {
 		if (auto draft = cloudDraft()) {
 			if (!Data::draftIsNull(draft) && draft->date > lastMsgDate) {
@@ -2508,6 +2646,50 @@ void History::clearUpTill(MsgId availableMinId) {
 	}
 }
 
+void History::unloadBlocks(
+		const base::flat_set<not_null<HistoryItem*>> &itemsInUse) {
+	auto items = std::vector<HistoryItem*>();
+	for (const auto block : blocks) {
+		for (const auto item : block->items) {
+			items.push_back(item);
+		}
+	}
+	clear(true);
+
+	const auto channel = peer->asChannel();
+	const auto pinnedId = channel ? channel->pinnedMessageId() : MsgId(0);
+	const auto keep = [&](HistoryItem *item) {
+		return (item == lastMsg)
+			|| !IsServerMsgId(item->id)
+			|| (item->id == pinnedId)
+			|| notifies.contains(item)
+			|| itemsInUse.contains(item)
+			|| App::historyItemHasDependents(item);
+	};
+
+	// Replies usually follow the messages they depend on, so going from
+	// the newest messages releases the dependencies before they are checked.
+	auto &pending = Global::RefPendingRepaintItems();
+	for (const auto item : base::reversed(items)) {
+		if (keep(item)) {
+			continue;
+		}
+		pending.remove(item);
+		if (textCachedFor == item) {
+			textCachedFor = nullptr;
+		}
+		delete item;
+	}
+}
+
+int History::loadedItemsCount() const {
+	auto result = 0;
+	for (const auto block : blocks) {
+		result += int(block->items.size());
+	}
+	return result;
+}
+
 void History::applyGroupAdminChanges(
 		const base::flat_map<UserId, bool> &changes) {
 	for (auto block : blocks) {
@@ -34,6 +34,7 @@ public:
 
 	Histories() : _a_typings(animation(this, &Histories::step_typings)) {
 		_selfDestructTimer.setCallback([this] { checkSelfDestructItems(); });
+		_unloadTimer.setCallback([this] { unloadInactive(); });
 	}
 
 	void registerSendAction(
@@ -92,8 +93,26 @@ public:
 	}
 	void selfDestructIn(not_null<HistoryItem*> item, TimeMs delay);
 
+	// While an UpdatesBatch exists the chat list positions of the
+	// changed histories are updated once, when the last batch ends.
+	class UpdatesBatch {
+	public:
+		UpdatesBatch();
+		UpdatesBatch(const UpdatesBatch &other) = delete;
+		UpdatesBatch &operator=(const UpdatesBatch &other) = delete;
+		~UpdatesBatch();
+
+	};
+	bool delayChatListSortPosition(not_null<History*> history);
+
 private:
+	void startUpdatesBatch();
+	void finishUpdatesBatch();
 	void checkSelfDestructItems();
+	void collectItemsInUse(
+		base::flat_set<not_null<HistoryItem*>> &items,
+		base::flat_set<not_null<PeerData*>> &peers) const;
+	void unloadInactive();
 
 	int _unreadFull = 0;
 	int _unreadMuted = 0;
@@ -103,6 +122,12 @@ private:
 	base::Timer _selfDestructTimer;
 	std::vector<FullMsgId> _selfDestructItems;
 
+	base::Timer _unloadTimer;
+
+	int _updatesBatchLevel = 0;
+	std::vector<not_null<History*>> _chatListSortDelayed;
+	base::flat_set<not_null<History*>> _chatListSortDelayedSet;
+
 };
 
 class HistoryBlock;
@@ -200,6 +225,19 @@ public:
 	void clear(bool leaveItems = false);
 	void clearUpTill(MsgId availableMinId);
 
+	// Detaches all the loaded messages and destroys those of them that
+	// are not referenced from elsewhere, they are requested again when
+	// the history is shown.
+	void unloadBlocks(
+		const base::flat_set<not_null<HistoryItem*>> &itemsInUse);
+	int loadedItemsCount() const;
+	TimeMs lastShownTime() const {
+		return _lastShownTime;
+	}
+	void markShown() {
+		_lastShownTime = getms(true);
+	}
+
 	void applyGroupAdminChanges(const base::flat_map<UserId, bool> &changes);
 
 	virtual ~History();
@@ -527,6 +565,7 @@ private:
 	Flags _flags = 0;
 	bool _mute = false;
 	int _unreadCount = 0;
+	TimeMs _lastShownTime = 0;
 
 	base::optional<int> _unreadMentionsCount;
 	base::flat_set<MsgId> _unreadMentions;
@@ -32,6 +32,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace {
 
 constexpr auto kScrollDateHideTimeout = 1000;
+constexpr auto kKeepHeavyScreensCount = 1;
+constexpr auto kClearHeavyItemsDelay = TimeMs(1000);
 
 class DateClickHandler : public ClickHandler {
 public:
@@ -134,6 +136,8 @@ HistoryInner::HistoryInner(
 
 	_trippleClickTimer.setSingleShot(true);
 
+	_clearHeavyItemsTimer.setCallback([this] { clearHeavyItems(); });
+
 	connect(&_scrollDateHideTimer, SIGNAL(timeout()), this, SLOT(onScrollDateHideByTimer()));
 
 	notifyIsBotChanged();
@@ -509,6 +513,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 					selfromy - mtop,
 					seltoy - mtop);
 				item->draw(p, clip.translated(0, -y), selection, ms);
+				_heavyItems.emplace(item);
 
 				if (item->hasViews()) {
 					App::main()->scheduleViewIncrement(item);
@@ -553,6 +558,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 						selfromy - htop,
 						seltoy - htop);
 					item->draw(p, hclip.translated(0, -y), selection, ms);
+					_heavyItems.emplace(item);
 
 					if (item->hasViews()) {
 						App::main()->scheduleViewIncrement(item);
@@ -1085,6 +1091,8 @@ void HistoryInner::itemRemoved(not_null<const HistoryItem*> item) {
 	if (_history != item->history() && _migrated != item->history()) {
 		return;
 	}
+	_heavyItems.remove(const_cast<HistoryItem*>(item.get()));
+
 	if (!App::main()) {
 		return;
 	}
@@ -1763,6 +1771,7 @@ void HistoryInner::recountHistoryGeometry() {
 	if (_migrated) {
 		_migrated->resizeGetHeight(_scroll->width());
 	}
+	collectHeavyItems();
 
 	// with migrated history we perhaps do not need to display first _history message
 	// (if last _migrated message and first _history message are both isGroupMigrate)
@@ -1906,6 +1915,59 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	} else {
 		onScrollDateHideByTimer();
 	}
+	_clearHeavyItemsTimer.callOnce(kClearHeavyItemsDelay);
+}
+
+void HistoryInner::collectHeavyItems() {
+	// Measuring loads the text layouts of all items, so the measured
+	// ones are registered here to be cleared when they are out of view.
+	auto measured = std::vector<not_null<HistoryItem*>>();
+	const auto collect = [&](History *history) {
+		if (!history) {
+			return;
+		}
+		for (const auto &block : history->blocks) {
+			for (const auto item : block->items) {
+				if (item->hasHeavyPart() && !_heavyItems.contains(item)) {
+					measured.push_back(item);
+				}
+			}
+		}
+	};
+	collect(_migrated);
+	collect(_history);
+	if (measured.empty()) {
+		return;
+	}
+	measured.insert(measured.end(), _heavyItems.begin(), _heavyItems.end());
+	ranges::sort(measured);
+	_heavyItems = base::flat_set<not_null<HistoryItem*>>(
+		measured.begin(),
+		measured.end());
+	_clearHeavyItemsTimer.callOnce(kClearHeavyItemsDelay);
+}
+
+void HistoryInner::clearHeavyItems() {
+	const auto visibleHeight = _visibleAreaBottom - _visibleAreaTop;
+	if (visibleHeight <= 0) {
+		return;
+	}
+	const auto keepTop = _visibleAreaTop
+		- kKeepHeavyScreensCount * visibleHeight;
+	const auto keepBottom = _visibleAreaBottom
+		+ kKeepHeavyScreensCount * visibleHeight;
+	for (auto i = _heavyItems.begin(); i != _heavyItems.end();) {
+		const auto item = i->get();
+		const auto top = itemTop(item);
+		if (top >= 0
+			&& top + item->height() > keepTop
+			&& top < keepBottom) {
+			++i;
+			continue;
+		}
+		item->clearHeavyPart();
+		i = _heavyItems.erase(i);
+	}
 }
 
 bool HistoryInner::displayScrollDate() const {
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/tooltip.h"
 #include "ui/widgets/scroll_area.h"
 #include "history/history_top_bar_widget.h"
+#include "base/timer.h"
 
 namespace Window {
 class Controller;
@@ -145,6 +146,8 @@ private:
 	void showContextMenu(QContextMenuEvent *e, bool showFromTouch = false);
 
 	void itemRemoved(not_null<const HistoryItem*> item);
+	void collectHeavyItems();
+	void clearHeavyItems();
 	void savePhotoToFile(PhotoData *photo);
 	void saveDocumentToFile(DocumentData *document);
 	void copyContextImage(PhotoData *photo);
@@ -287,6 +290,10 @@ private:
 	int _visibleAreaTop = 0;
 	int _visibleAreaBottom = 0;
 
+	// painted or measured items that keep their text layout
+	base::flat_set<not_null<HistoryItem*>> _heavyItems;
+	base::Timer _clearHeavyItemsTimer;
+
 	bool _scrollDateShown = false;
 	Animation _scrollDateOpacity;
 	SingleQueuedInvokation _scrollDateCheck;
@@ -141,6 +141,9 @@ void HistoryItem::finishEdition(int oldKeyboardTop) {
 			keyboard->oldTop = oldKeyboardTop;
 		}
 	}
+	if (!detached()) {
+		Auth().data().searchIndex().add(this);
+	}
 
 	App::historyUpdateDependent(this);
 }
@@ -407,6 +407,15 @@ public:
 		return _text.isEmpty();
 	}
 
+	// Drops the text layout of an item that was scrolled away, it is
+	// built again when the item is drawn or resized.
+	void clearHeavyPart() {
+		_text.unloadWords();
+	}
+	bool hasHeavyPart() const {
+		return !_text.isEmpty() && !_text.wordsUnloaded();
+	}
+
 	bool isPinned() const;
 	bool canPin() const;
 	bool canForward() const;
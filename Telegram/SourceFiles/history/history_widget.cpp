@@ -1631,6 +1631,7 @@ void HistoryWidget::showHistory(const PeerId &peerId, MsgId showAtMsgId, bool re
 	clearAllLoadRequests();
 
 	if (_history) {
+		_history->markShown();
 		if (App::main()) App::main()->saveDraftToCloud();
 		if (_migrated) {
 			_migrated->clearLocalDraft(); // use migrated draft only once
@@ -1710,6 +1711,7 @@ void HistoryWidget::showHistory(const PeerId &peerId, MsgId showAtMsgId, bool re
 
 		_history = App::history(_peer);
 		_migrated = _history->migrateFrom();
+		_history->markShown();
 
 		if (_channel) {
 			updateNotifySettings();
@@ -5181,7 +5183,8 @@ void HistoryWidget::onInlineResultSend(
 		App::main()->rpcFail(&MainWidget::sendMessageFail),
 		0,
 		0,
-		_history->sendRequestId);
+		_history->sendRequestId,
+		MTP::RequestPriority::Interactive);
 	App::main()->finishForwarding(_history);
 
 	App::historyRegRandom(randomId, newId);
@@ -5386,7 +5389,8 @@ bool HistoryWidget::sendExistingDocument(
 		App::main()->rpcFail(&MainWidget::sendMessageFail),
 		0,
 		0,
-		_history->sendRequestId);
+		_history->sendRequestId,
+		MTP::RequestPriority::Interactive);
 	App::main()->finishForwarding(_history);
 
 	if (doc->sticker()) App::main()->incrementSticker(doc);
@@ -5473,7 +5477,8 @@ void HistoryWidget::sendExistingPhoto(
 		App::main()->rpcFail(&MainWidget::sendMessageFail),
 		0,
 		0,
-		_history->sendRequestId);
+		_history->sendRequestId,
+		MTP::RequestPriority::Interactive);
 	App::main()->finishForwarding(_history);
 
 	App::historyRegRandom(randomId, newId);
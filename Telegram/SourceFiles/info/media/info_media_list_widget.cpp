@@ -38,6 +38,7 @@ constexpr auto kPreloadIfLessThanScreens = 2;
 constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kMediaCountForSearch = 10;
+constexpr auto kKeepHeavyScreensCount = 1;
 
 UniversalMsgId GetUniversalId(FullMsgId itemId) {
 	return (itemId.channel != 0)
@@ -60,6 +61,7 @@ struct ListWidget::Context {
 	not_null<SelectedMap*> selected;
 	not_null<SelectedMap*> dragSelected;
 	DragSelectAction dragSelectAction;
+	not_null<base::flat_set<not_null<BaseLayout*>>*> heavyLayouts;
 };
 
 class ListWidget::Section {
@@ -392,6 +394,7 @@ void ListWidget::Section::paint(
 				itemSelection(item, context),
 				&localContext);
 			p.translate(-rect.topLeft());
+			context.heavyLayouts->emplace(item);
 		}
 	}
 }
@@ -569,6 +572,14 @@ void ListWidget::start() {
 	) | rpl::start_with_next([this](auto item) {
 		repaintItem(item);
 	}, lifetime());
+	ObservableViewer(
+		Auth().data().queryItemsInUse()
+	) | rpl::start_with_next([this](const auto &query) {
+		query.peers->emplace(_peer);
+		if (_migrated) {
+			query.peers->emplace(_migrated);
+		}
+	}, lifetime());
 	_controller->mediaSourceQueryValue(
 	) | rpl::start_with_next([this]{
 		restart();
@@ -601,6 +612,7 @@ void ListWidget::restart() {
 
 	_overLayout = nullptr;
 	_sections.clear();
+	_heavyLayouts.clear();
 	_layouts.clear();
 
 	_universalAroundId = kDefaultAroundId;
@@ -629,6 +641,9 @@ void ListWidget::itemRemoved(not_null<const HistoryItem*> item) {
 			_overLayout = nullptr;
 		}
 
+		if (const auto layout = getExistingLayout(universalId)) {
+			_heavyLayouts.remove(layout);
+		}
 		_layouts.erase(universalId);
 		_dragSelected.remove(universalId);
 
@@ -1006,6 +1021,7 @@ void ListWidget::visibleTopBottomUpdated(
 	_visibleBottom = visibleBottom;
 
 	checkMoveToOtherViewer();
+	clearHeavyItems();
 }
 
 void ListWidget::checkMoveToOtherViewer() {
@@ -1119,7 +1135,8 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 		Layout::PaintContext(ms, hasSelectedItems()),
 		&_selected,
 		&_dragSelected,
-		_dragSelectAction
+		_dragSelectAction,
+		&_heavyLayouts
 	};
 	for (auto it = fromSectionIt; it != tillSectionIt; ++it) {
 		auto top = it->top();
@@ -2051,9 +2068,13 @@ void ListWidget::mouseActionUpdate() {
 void ListWidget::clearStaleLayouts() {
 	for (auto i = _layouts.begin(); i != _layouts.end();) {
 		if (i->second.stale) {
-			if (i->second.item.get() == _overLayout) {
+			const auto layout = i->second.item.get();
+			if (layout == _overLayout) {
 				_overLayout = nullptr;
 			}
+			if (_heavyLayouts.remove(layout)) {
+				layout->clearHeavyPart();
+			}
 			i = _layouts.erase(i);
 		} else {
 			++i;
@@ -2061,6 +2082,30 @@ void ListWidget::clearStaleLayouts() {
 	}
 }
 
+void ListWidget::clearHeavyItems() {
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	if (visibleHeight <= 0) {
+		return;
+	}
+	const auto keepTop = _visibleTop
+		- kKeepHeavyScreensCount * visibleHeight;
+	const auto keepBottom = _visibleBottom
+		+ kKeepHeavyScreensCount * visibleHeight;
+	for (auto i = _heavyLayouts.begin(); i != _heavyLayouts.end();) {
+		const auto layout = i->get();
+		if (const auto found = findItemDetails(layout)) {
+			const auto &geometry = found->geometry;
+			if (geometry.y() + geometry.height() > keepTop
+				&& geometry.y() < keepBottom) {
+				++i;
+				continue;
+			}
+		}
+		layout->clearHeavyPart();
+		i = _heavyLayouts.erase(i);
+	}
+}
+
 auto ListWidget::findSectionByItem(
 		UniversalMsgId universalId) -> std::vector<Section>::iterator {
 	return ranges::lower_bound(
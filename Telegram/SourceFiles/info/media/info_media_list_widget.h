@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/rp_widget.h"
 #include "info/media/info_media_widget.h"
 #include "data/data_shared_media.h"
+#include "base/flat_set.h"
 
 namespace Ui {
 class PopupMenu;
@@ -211,6 +212,7 @@ private:
 
 	void markLayoutsStale();
 	void clearStaleLayouts();
+	void clearHeavyItems();
 	std::vector<Section>::iterator findSectionByItem(
 		UniversalMsgId universalId);
 	std::vector<Section>::iterator findSectionAfterTop(int top);
@@ -270,6 +272,9 @@ private:
 	std::map<UniversalMsgId, CachedItem> _layouts;
 	std::vector<Section> _sections;
 
+	// Painted layouts that may hold pixmaps and decoded images.
+	base::flat_set<not_null<BaseLayout*>> _heavyLayouts;
+
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
 	ScrollTopState _scrollTopState;
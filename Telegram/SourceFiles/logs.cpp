@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/connection.h"
 #include "core/crash_reports.h"
 #include "core/launcher.h"
+#include "base/zlib_help.h"
 
 enum LogDataType {
 	LogDataMain,
@@ -43,6 +44,13 @@ QString _logsFilePath(LogDataType type, const QString &postfix = QString()) {
 	return path;
 }
 
+namespace {
+
+constexpr auto kDebugQueueLimit = 4 * 1024 * 1024; // characters
+constexpr auto kDebugPartSizeLimit = qint64(32 * 1024 * 1024);
+
+} // namespace
+
 int32 LogsStartIndexChosen = -1;
 QString _logsEntryStart() {
 	static int32 index = 0;
@@ -54,15 +62,52 @@ QString _logsEntryStart() {
 	return QString("[%1 %2-%3]").arg(tm.toString("hh:mm:ss.zzz")).arg(QString("%1").arg(threadId, 2, 10, QChar('0'))).arg(++index, 7, 10, QChar('0'));
 }
 
+class LogsDataFields;
+
+// Debug, tcp and mtp logs are written by a separate thread, so that the
+// connection threads only append a line to the queue under a short lock
+// and never wait for the disk. The queue size is limited, if the writer
+// can't keep up the lines are dropped and the number of them is logged.
+class LogsWriter : public QThread {
+public:
+	using Entry = std::pair<LogDataType, QString>;
+
+	LogsWriter(not_null<LogsDataFields*> fields) : _fields(fields) {
+	}
+
+	void push(LogDataType type, const QString &msg);
+
+	// Writes everything that was queued and waits for the thread.
+	void stop();
+
+protected:
+	void run() override;
+
+private:
+	not_null<LogsDataFields*> _fields;
+	QMutex _mutex;
+	QWaitCondition _condition;
+	std::vector<Entry> _queue;
+	int _queueSize = 0;
+	int _dropped = 0;
+	bool _started = false;
+	bool _stopping = false;
+
+};
+
 class LogsDataFields {
 public:
 
-	LogsDataFields() {
+	LogsDataFields() : _writer(this) {
 		for (int32 i = 0; i < LogDataCount; ++i) {
 			files[i].reset(new QFile());
 		}
 	}
 
+	~LogsDataFields() {
+		_writer.stop();
+	}
+
 	bool openMain() {
 		return reopen(LogDataMain, 0, qsl("start"));
 	}
@@ -92,19 +137,50 @@ public:
 	}
 
 	void write(LogDataType type, const QString &msg) {
+		if (type != LogDataMain) {
+			_writer.push(type, msg);
+			return;
+		}
 		QMutexLocker lock(_logsMutex(type));
-		if (type != LogDataMain) reopenDebug();
 		if (!streams[type].device()) return;
 
 		streams[type] << msg;
 		streams[type].flush();
 	}
 
+	// Called only from the writer thread.
+	void writeDebug(const std::vector<LogsWriter::Entry> &entries, int dropped) {
+		reopenDebug();
+		if (dropped && streams[LogDataDebug].device()) {
+			streams[LogDataDebug] << QString("%1 debug log lines were dropped!\n").arg(dropped);
+		}
+		for (const auto &[type, msg] : entries) {
+			if (streams[type].device()) {
+				streams[type] << msg;
+			}
+		}
+		for (const auto type : { LogDataDebug, LogDataTcp, LogDataMtp }) {
+			if (!streams[type].device()) {
+				continue;
+			}
+			streams[type].flush();
+			if (files[type]->size() > kDebugPartSizeLimit) {
+				const auto sizePart = ++sizeParts[type];
+				reopenPart(type, partPostfix + QString("_%1").arg(sizePart));
+			}
+		}
+	}
+
 private:
 	std::unique_ptr<QFile> files[LogDataCount];
 	QTextStream streams[LogDataCount];
 
 	int32 part = -1;
+	int32 dayIndex = 0;
+	QString partPostfix;
+	int sizeParts[LogDataCount] = { 0 };
+
+	LogsWriter _writer;
 
 	bool reopen(LogDataType type, int32 dayIndex, const QString &postfix) {
 		if (streams[type].device()) {
@@ -223,16 +299,108 @@ NEW LOGGING INSTANCE STARTED!!!\n\
 
 		part = newPart;
 
-		int32 dayIndex = (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
-		QString postfix = QString("_%4_%5").arg((part * switchEach) / 60, 2, 10, QChar('0')).arg((part * switchEach) % 60, 2, 10, QChar('0'));
+		dayIndex = (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+		partPostfix = QString("_%4_%5").arg((part * switchEach) / 60, 2, 10, QChar('0')).arg((part * switchEach) % 60, 2, 10, QChar('0'));
 
-		reopen(LogDataDebug, dayIndex, postfix);
-		reopen(LogDataTcp, dayIndex, postfix);
-		reopen(LogDataMtp, dayIndex, postfix);
+		for (const auto type : { LogDataDebug, LogDataTcp, LogDataMtp }) {
+			sizeParts[type] = 0;
+			reopenPart(type, partPostfix);
+		}
+	}
+
+	void reopenPart(LogDataType type, const QString &postfix) {
+		const auto was = streams[type].device()
+			? files[type]->fileName()
+			: QString();
+		reopen(type, dayIndex, postfix);
+		if (!was.isEmpty() && was != files[type]->fileName()) {
+			compressPart(was);
+		}
+	}
+
+	// Finished parts are replaced by zip archives with the same name.
+	void compressPart(const QString &path) {
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly)) {
+			return;
+		}
+		const auto content = file.readAll();
+		file.close();
+
+		zlib::FileToWrite zip;
+		zip_fileinfo zfi = { { 0, 0, 0, 0, 0, 0 }, 0, 0, 0 };
+		const auto name = QFileInfo(path).fileName().toUtf8();
+		zip.openNewFile(name.constData(), &zfi, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_DEFAULT_COMPRESSION);
+		zip.writeInFile(content.constData(), content.size());
+		zip.closeFile();
+		zip.close();
+		if (zip.error() != ZIP_OK) {
+			LOG(("Could not compress debug log '%1', status: %2").arg(path).arg(zip.error()));
+			return;
+		}
+		const auto result = zip.result();
+		QFile compressed(path + qstr(".zip"));
+		if (!compressed.open(QIODevice::WriteOnly)
+			|| compressed.write(result) != result.size()) {
+			LOG(("Could not write compressed debug log '%1'!").arg(compressed.fileName()));
+			compressed.remove();
+			return;
+		}
+		compressed.close();
+		file.remove();
 	}
 
 };
 
+void LogsWriter::push(LogDataType type, const QString &msg) {
+	QMutexLocker lock(&_mutex);
+	if (_stopping) {
+		return;
+	} else if (_queueSize + msg.size() > kDebugQueueLimit) {
+		++_dropped;
+		return;
+	}
+	_queue.emplace_back(type, msg);
+	_queueSize += msg.size();
+	if (!_started) {
+		_started = true;
+		start();
+	}
+	_condition.wakeOne();
+}
+
+void LogsWriter::stop() {
+	{
+		QMutexLocker lock(&_mutex);
+		_stopping = true;
+		_condition.wakeOne();
+	}
+	wait();
+}
+
+void LogsWriter::run() {
+	auto entries = std::vector<Entry>();
+	while (true) {
+		auto dropped = 0;
+		auto stopping = false;
+		{
+			QMutexLocker lock(&_mutex);
+			while (_queue.empty() && !_dropped && !_stopping) {
+				_condition.wait(&_mutex);
+			}
+			std::swap(entries, _queue);
+			_queueSize = 0;
+			dropped = base::take(_dropped);
+			stopping = _stopping;
+		}
+		_fields->writeDebug(entries, dropped);
+		entries.clear();
+		if (stopping) {
+			return;
+		}
+	}
+}
+
 LogsDataFields *LogsData = 0;
 
 typedef QList<QPair<LogDataType, QString> > LogsInMemoryList;
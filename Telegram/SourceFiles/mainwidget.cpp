@@ -54,6 +54,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "boxes/download_path_box.h"
 #include "storage/localstorage.h"
 #include "shortcuts.h"
+#include "core/startup_trace.h"
 #include "media/media_audio.h"
 #include "media/player/media_player_panel.h"
 #include "media/player/media_player_widget.h"
@@ -1538,7 +1539,8 @@ void MainWidget::sendMessage(const MessageToSend &message) {
 			rpcFail(&MainWidget::sendMessageFail),
 			0,
 			0,
-			history->sendRequestId);
+			history->sendRequestId,
+			MTP::RequestPriority::Interactive);
 	}
 
 	history->lastSentMsg = lastMessage;
@@ -3586,6 +3588,7 @@ void MainWidget::onUpdateNotifySettings() {
 }
 
 void MainWidget::feedUpdateVector(const MTPVector<MTPUpdate> &updates, bool skipMessageIds) {
+	Histories::UpdatesBatch batch;
 	for_const (auto &update, updates.v) {
 		if (skipMessageIds && update.type() == mtpc_updateMessageID) continue;
 		feedUpdate(update);
@@ -3652,6 +3655,8 @@ void MainWidget::gotChannelDifference(ChannelData *channel, const MTPupdates_Cha
 
 		App::feedUsers(d.vusers);
 		App::feedChats(d.vchats);
+
+		Histories::UpdatesBatch batch;
 		auto h = App::historyLoaded(channel->id);
 		if (h) {
 			h->setNotLoadedAtBottom();
@@ -3685,6 +3690,7 @@ void MainWidget::gotChannelDifference(ChannelData *channel, const MTPupdates_Cha
 		App::feedChats(d.vchats);
 
 		_handlingChannelDifference = true;
+		Histories::UpdatesBatch batch;
 		feedMessageIds(d.vother_updates);
 
 		// feed messages and groups, copy from App::feedMsgs
@@ -3758,9 +3764,12 @@ void MainWidget::gotRangeDifference(ChannelData *channel, const MTPupdates_Chann
 		App::feedChats(d.vchats);
 
 		_handlingChannelDifference = true;
-		feedMessageIds(d.vother_updates);
-		App::feedMsgs(d.vnew_messages, NewMessageUnread);
-		feedUpdateVector(d.vother_updates, true);
+		{
+			Histories::UpdatesBatch batch;
+			feedMessageIds(d.vother_updates);
+			App::feedMsgs(d.vnew_messages, NewMessageUnread);
+			feedUpdateVector(d.vother_updates, true);
+		}
 		_handlingChannelDifference = false;
 
 		nextRequestPts = d.vpts.v;
@@ -3919,9 +3928,12 @@ void MainWidget::feedDifference(const MTPVector<MTPUser> &users, const MTPVector
 	Auth().checkAutoLock();
 	App::feedUsers(users);
 	App::feedChats(chats);
-	feedMessageIds(other);
-	App::feedMsgs(msgs, NewMessageUnread);
-	feedUpdateVector(other, true);
+	{
+		Histories::UpdatesBatch batch;
+		feedMessageIds(other);
+		App::feedMsgs(msgs, NewMessageUnread);
+		feedUpdateVector(other, true);
+	}
 	_history->peerMessagesUpdated();
 }
 
@@ -4052,14 +4064,19 @@ void MainWidget::start(const MTPUser *self) {
 
 	_started = true;
 	App::wnd()->sendServiceHistoryRequest();
-	Local::readInstalledStickers();
-	Local::readFeaturedStickers();
-	Local::readRecentStickers();
-	Local::readFavedStickers();
-	Local::readSavedGifs();
+	{
+		StartupTrace::Span trace("MainWidget::readStickers");
+		Local::readInstalledStickers();
+		Local::readFeaturedStickers();
+		Local::readRecentStickers();
+		Local::readFavedStickers();
+		Local::readSavedGifs();
+	}
 	_history->start();
 
 	Messenger::Instance().checkStartUrl();
+
+	StartupTrace::Finish();
 }
 
 bool MainWidget::started() {
@@ -255,11 +255,12 @@ namespace Player {
 namespace {
 
 constexpr auto kVolumeRound = 10000;
-constexpr auto kPreloadSamples = 2LL * kDefaultFrequency; // preload next part if less than 2 seconds remains
+constexpr auto kPreloadSamples = 3LL * kDefaultFrequency; // preload next part if less than 3 seconds remains
 constexpr auto kFadeDuration = TimeMs(500);
 constexpr auto kCheckPlaybackPositionTimeout = TimeMs(100); // 100ms per check audio position
 constexpr auto kCheckPlaybackPositionDelta = 2400LL; // update position called each 2400 samples
 constexpr auto kCheckFadingTimeout = TimeMs(7); // 7ms
+constexpr auto kWakeupsLogPeriod = TimeMs(10000);
 
 base::Observable<AudioMsgId> UpdatedObservable;
 
@@ -289,16 +290,16 @@ void Mixer::Track::createStream() {
 	alSource3f(stream.source, AL_POSITION, 0, 0, 0);
 	alSource3f(stream.source, AL_VELOCITY, 0, 0, 0);
 	alSourcei(stream.source, AL_LOOPING, 0);
-	alGenBuffers(3, stream.buffers);
+	alGenBuffers(kBuffersCount, stream.buffers);
 }
 
 void Mixer::Track::destroyStream() {
 	if (isStreamCreated()) {
-		alDeleteBuffers(3, stream.buffers);
+		alDeleteBuffers(kBuffersCount, stream.buffers);
 		alDeleteSources(1, &stream.source);
 	}
 	stream.source = 0;
-	for (auto i = 0; i != 3; ++i) {
+	for (auto i = 0; i != kBuffersCount; ++i) {
 		stream.buffers[i] = 0;
 	}
 }
@@ -353,6 +354,7 @@ void Mixer::Track::clear() {
 		samplesCount[i] = 0;
 		bufferSamples[i] = QByteArray();
 	}
+	freeSamples = QByteArray();
 
 	videoData = nullptr;
 	lastUpdateWhen = 0;
@@ -404,6 +406,7 @@ int Mixer::Track::getNotQueuedBufferIndex() {
 		for (auto i = 0; i != kBuffersCount; ++i) {
 			if (stream.buffers[i] == buffer) {
 				auto samplesInBuffer = samplesCount[i];
+				auto samples = std::move(bufferSamples[i]);
 				bufferedPosition += samplesInBuffer;
 				bufferedLength -= samplesInBuffer;
 				for (auto j = i + 1; j != kBuffersCount; ++j) {
@@ -414,6 +417,7 @@ int Mixer::Track::getNotQueuedBufferIndex() {
 				samplesCount[kBuffersCount - 1] = 0;
 				stream.buffers[kBuffersCount - 1] = buffer;
 				bufferSamples[kBuffersCount - 1] = QByteArray();
+				freeSamples = std::move(samples);
 				found = true;
 				break;
 			}
@@ -432,6 +436,16 @@ int Mixer::Track::getNotQueuedBufferIndex() {
 	return -1;
 }
 
+QByteArray Mixer::Track::takeFreeSamples() {
+	auto result = base::take(freeSamples);
+
+	// Reserved capacity is kept by resize(0), so the decoded samples
+	// are appended without reallocations.
+	result.reserve(qMax(result.capacity(), int(AudioVoiceMsgBufferSize)));
+	result.resize(0);
+	return result;
+}
+
 void Mixer::Track::resetStream() {
 	if (isStreamCreated()) {
 		alSourceStop(stream.source);
@@ -1117,10 +1131,20 @@ void Fader::onTimer() {
 	QMutexLocker lock(&AudioMutex);
 	if (!mixer()) return;
 
+	const auto ms = getms();
+	countWakeup(ms);
+
+	// Each part lowers the delay till the next moment it needs an update.
+	auto wakeupIn = TimeMs(-1);
+	const auto wakeupAfter = [&wakeupIn](TimeMs delay) {
+		if (wakeupIn < 0 || delay < wakeupIn) {
+			wakeupIn = delay;
+		}
+	};
+
 	auto volumeChangedAll = false;
 	auto volumeChangedSong = false;
 	if (_suppressAll || _suppressSongAnim) {
-		auto ms = getms();
 		if (_suppressAll) {
 			if (ms >= _suppressAllEnd || ms < _suppressAllStart) {
 				_suppressAll = _suppressAllAnim = false;
@@ -1139,6 +1163,16 @@ void Fader::onTimer() {
 			auto wasVolumeMultiplierAll = VolumeMultiplierAll;
 			VolumeMultiplierAll = _suppressVolumeAll.current();
 			volumeChangedAll = (VolumeMultiplierAll != wasVolumeMultiplierAll);
+
+			if (_suppressAll) {
+				const auto unsuppressAt = _suppressAllEnd - kFadeDuration;
+				if (_suppressAllAnim || ms > unsuppressAt) {
+					wakeupAfter(kCheckFadingTimeout);
+				} else {
+					// The volume stays the same till the fade out starts.
+					wakeupAfter(unsuppressAt + 1 - ms);
+				}
+			}
 		}
 		if (_suppressSongAnim) {
 			if (ms >= _suppressSongStart + kFadeDuration) {
@@ -1146,6 +1180,7 @@ void Fader::onTimer() {
 				_suppressSongAnim = false;
 			} else {
 				_suppressVolumeSong.update((ms - _suppressSongStart) / float64(kFadeDuration), anim::linear);
+				wakeupAfter(kCheckFadingTimeout);
 			}
 		}
 		auto wasVolumeMultiplierSong = VolumeMultiplierSong;
@@ -1156,11 +1191,15 @@ void Fader::onTimer() {
 	auto hasFading = (_suppressAll || _suppressSongAnim);
 	auto hasPlaying = false;
 
-	auto updatePlayback = [this, &hasPlaying, &hasFading](AudioMsgId::Type type, int index, float64 volumeMultiplier, bool suppressGainChanged) {
+	auto updatePlayback = [&](AudioMsgId::Type type, int index, float64 volumeMultiplier, bool suppressGainChanged) {
 		auto track = mixer()->trackForType(type, index);
 		if (IsStopped(track->state.state) || track->state.state == State::Paused || !track->isStreamCreated()) return;
 
-		auto emitSignals = updateOnePlayback(track, hasPlaying, hasFading, volumeMultiplier, suppressGainChanged);
+		auto checkIn = TimeMs(-1);
+		auto emitSignals = updateOnePlayback(track, hasPlaying, hasFading, checkIn, volumeMultiplier, suppressGainChanged);
+		if (checkIn >= 0) {
+			wakeupAfter(checkIn);
+		}
 		if (emitSignals & EmitError) emit error(track->state.id);
 		if (emitSignals & EmitStopped) emit audioStopped(track->state.id);
 		if (emitSignals & EmitPositionUpdated) emit playPositionUpdated(track->state.id);
@@ -1178,18 +1217,53 @@ void Fader::onTimer() {
 
 	_volumeChangedSong = _volumeChangedVideo = false;
 
-	if (hasFading) {
-		_timer.start(kCheckFadingTimeout);
-		Audio::StopDetachIfNotUsedSafe();
-	} else if (hasPlaying) {
-		_timer.start(kCheckPlaybackPositionTimeout);
+	if (hasFading || hasPlaying) {
+		_timer.start((wakeupIn >= 0) ? wakeupIn : kCheckFadingTimeout);
 		Audio::StopDetachIfNotUsedSafe();
 	} else {
+		_timer.stop();
+		_wakeupsCountStart = 0;
 		Audio::ScheduleDetachIfNotUsedSafe();
 	}
 }
 
-int32 Fader::updateOnePlayback(Mixer::Track *track, bool &hasPlaying, bool &hasFading, float64 volumeMultiplier, bool volumeChanged) {
+void Fader::countWakeup(TimeMs ms) {
+	if (!cDebug()) {
+		return;
+	}
+	++_wakeupsCount;
+	if (!_wakeupsCountStart) {
+		_wakeupsCountStart = ms;
+		_wakeupsCount = 1;
+	} else if (ms - _wakeupsCountStart >= kWakeupsLogPeriod) {
+		const auto period = ms - _wakeupsCountStart;
+		DEBUG_LOG(("Audio Info: Fader woke up %1 times in %2 ms (%3 per second)."
+			).arg(_wakeupsCount
+			).arg(period
+			).arg(_wakeupsCount * 1000. / period, 0, 'f', 1));
+		_wakeupsCountStart = ms;
+		_wakeupsCount = 0;
+	}
+}
+
+TimeMs Fader::countPlayingCheckTimeout(const Mixer::Track *track, int64 fullPosition) const {
+	const auto frequency = track->state.frequency;
+	if (frequency <= 0) {
+		return kCheckPlaybackPositionTimeout;
+	}
+
+	// Wake up when the buffered samples end, so that the end of playback
+	// or a buffer underrun is noticed, and when the preload is needed.
+	const auto bufferedTill = track->bufferedPosition + track->bufferedLength;
+	auto samples = bufferedTill - fullPosition;
+	if (!track->loaded && !track->loading) {
+		accumulate_min(samples, bufferedTill - kPreloadSamples - track->state.position);
+	}
+	const auto result = (samples * 1000) / frequency;
+	return snap(TimeMs(result), kCheckFadingTimeout, kCheckPlaybackPositionTimeout);
+}
+
+int32 Fader::updateOnePlayback(Mixer::Track *track, bool &hasPlaying, bool &hasFading, TimeMs &checkIn, float64 volumeMultiplier, bool volumeChanged) {
 	auto playing = false;
 	auto fading = false;
 
@@ -1291,8 +1365,14 @@ int32 Fader::updateOnePlayback(Mixer::Track *track, bool &hasPlaying, bool &hasF
 			}
 		}
 	}
-	if (playing) hasPlaying = true;
-	if (fading) hasFading = true;
+	if (playing) {
+		hasPlaying = true;
+		checkIn = countPlayingCheckTimeout(track, fullPosition);
+	}
+	if (fading) {
+		hasFading = true;
+		checkIn = kCheckFadingTimeout;
+	}
 
 	return emitSignals;
 }
@@ -170,7 +170,9 @@ private:
 
 	class Track {
 	public:
-		static constexpr int kBuffersCount = 3;
+		// With at least 1.3 seconds in each buffer four of them always
+		// leave a free one when the next part is preloaded.
+		static constexpr int kBuffersCount = 4;
 
 		// Thread: Any. Must be locked: AudioMutex.
 		void reattach(AudioMsgId::Type type);
@@ -184,6 +186,10 @@ private:
 
 		int getNotQueuedBufferIndex();
 
+		// Thread: Loaders. Must be locked: AudioMutex.
+		// Returns an empty array with the capacity of a played buffer.
+		QByteArray takeFreeSamples();
+
 		~Track();
 
 		TrackState state;
@@ -200,6 +206,7 @@ private:
 		int32 frequency = kDefaultFrequency;
 		int samplesCount[kBuffersCount] = { 0 };
 		QByteArray bufferSamples[kBuffersCount];
+		QByteArray freeSamples;
 
 		struct Stream {
 			uint32 source = 0;
@@ -277,10 +284,16 @@ private:
 		EmitPositionUpdated = 0x04,
 		EmitNeedToPreload = 0x08,
 	};
-	int32 updateOnePlayback(Mixer::Track *track, bool &hasPlaying, bool &hasFading, float64 volumeMultiplier, bool volumeChanged);
+	int32 updateOnePlayback(Mixer::Track *track, bool &hasPlaying, bool &hasFading, TimeMs &checkIn, float64 volumeMultiplier, bool volumeChanged);
+	TimeMs countPlayingCheckTimeout(const Mixer::Track *track, int64 fullPosition) const;
 	void setStoppedState(Mixer::Track *track, State state = State::Stopped);
+	void countWakeup(TimeMs ms);
 
+	// Single shot, started for the nearest moment some fade step, position
+	// update or buffer end needs a check, instead of a constant polling.
 	QTimer _timer;
+	int _wakeupsCount = 0;
+	TimeMs _wakeupsCountStart = 0;
 
 	bool _volumeChangedSong = false;
 	bool _volumeChangedVideo = false;
@@ -143,6 +143,14 @@ void Loaders::loadData(AudioMsgId audio, TimeMs positionMs) {
 	int64 samplesCount = 0;
 	if (l->holdsSavedDecodedSamples()) {
 		l->takeSavedDecodedSamples(&samples, &samplesCount);
+	} else {
+		QMutexLocker lock(internal::audioPlayerMutex());
+		if (const auto track = checkLoader(type)) {
+			samples = track->takeFreeSamples();
+		} else {
+			clear(type);
+			return;
+		}
 	}
 	while (samples.size() < AudioVoiceMsgBufferSize) {
 		auto res = l->readMore(samples, samplesCount);
@@ -0,0 +1,176 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/view/media_view_prefetcher.h"
+
+#include "data/data_photo.h"
+
+namespace Media {
+namespace View {
+namespace {
+
+constexpr auto kPreloadCount = 4;
+constexpr auto kPreloadCountFast = 12;
+
+// Moves in one direction more often than that are counted as fast.
+constexpr auto kFastMoveTimeout = TimeMs(400);
+
+// A full screen image is up to 32mb on a 4k screen.
+constexpr auto kPreparedSizeLimit = int64(96 * 1024 * 1024);
+
+} // namespace
+
+int Prefetcher::preloadCount(int delta) {
+	const auto now = getms();
+	if (!delta) {
+		_fastMoves = 0;
+	} else if (delta == _lastDelta && now < _lastMoveTime + kFastMoveTimeout) {
+		++_fastMoves;
+	} else {
+		_fastMoves = 0;
+	}
+	_lastDelta = delta;
+	_lastMoveTime = now;
+	return std::min(kPreloadCount + 2 * _fastMoves, kPreloadCountFast);
+}
+
+void Prefetcher::prefetch(std::vector<Request> &&requests) {
+	_requests = std::move(requests);
+
+	for (const auto photo : base::take(_downloading)) {
+		if (!photo->loading()) {
+			continue;
+		} else if (wanted(photo)) {
+			_downloading.emplace(photo);
+		} else {
+			photo->cancel();
+		}
+	}
+	for (auto i = _prepared.begin(); i != _prepared.end();) {
+		if (wanted(i->first)) {
+			++i;
+		} else {
+			_preparedSize -= int64(i->second.size.width())
+				* i->second.size.height()
+				* 4;
+			i = _prepared.erase(i);
+		}
+	}
+	for (const auto &request : _requests) {
+		const auto photo = request.photo;
+		if (!photo->full->loaded() && !photo->loading()) {
+			photo->download();
+			_downloading.emplace(photo);
+		}
+	}
+	decodeNext();
+}
+
+void Prefetcher::checkLoaded() {
+	if (!_requests.empty()) {
+		decodeNext();
+	}
+}
+
+bool Prefetcher::wanted(not_null<PhotoData*> photo) const {
+	return ranges::find(_requests, photo, &Request::photo)
+		!= end(_requests);
+}
+
+QPixmap Prefetcher::take(not_null<PhotoData*> photo, QSize size) {
+	// The photo is shown now in any case, no need to prepare it anymore.
+	_requests.erase(
+		ranges::remove(_requests, photo, &Request::photo),
+		end(_requests));
+
+	const auto i = _prepared.find(photo);
+	if (i == _prepared.end() || i->second.size != size) {
+		++_misses;
+		return QPixmap();
+	}
+	++_hits;
+	auto result = std::move(i->second.pixmap);
+	_preparedSize -= int64(size.width()) * size.height() * 4;
+	_prepared.erase(i);
+	return result;
+}
+
+void Prefetcher::decodeNext() {
+	if (_decoding) {
+		return;
+	}
+	for (const auto &request : _requests) {
+		const auto photo = request.photo;
+		const auto size = request.size;
+		const auto bytes = (size.isEmpty() || _prepared.contains(photo))
+			? QByteArray()
+			: photo->full->loaded()
+			? photo->full->savedData()
+			: QByteArray();
+		if (bytes.isEmpty()) {
+			continue;
+		}
+		const auto imageSize = int64(size.width()) * size.height() * 4;
+		if (_preparedSize + imageSize > kPreparedSizeLimit) {
+			return;
+		}
+		_decoding = photo;
+
+		const auto weak = make_weak(this);
+		crl::async([=] {
+			auto format = QByteArray();
+			auto image = App::readImage(bytes, &format, false, nullptr, size);
+			if (!image.isNull() && image.size() != size) {
+				image = image.scaled(
+					size,
+					Qt::IgnoreAspectRatio,
+					Qt::SmoothTransformation);
+			}
+			crl::on_main(weak, [=, image = std::move(image)]() mutable {
+				decodeDone(photo, size, std::move(image));
+			});
+		});
+		return;
+	}
+}
+
+void Prefetcher::decodeDone(
+		not_null<PhotoData*> photo,
+		QSize size,
+		QImage &&image) {
+	_decoding = nullptr;
+	const auto i = ranges::find(_requests, photo, &Request::photo);
+	if (i == end(_requests) || i->size != size) {
+		// The request is stale, decode the next one.
+	} else if (image.isNull()) {
+		// Remember the failure with an empty size, so that we don't retry.
+		_prepared.emplace(photo, Prepared());
+	} else {
+		image.setDevicePixelRatio(cRetinaFactor());
+		_prepared.emplace(
+			photo,
+			Prepared{ size, App::pixmapFromImageInPlace(std::move(image)) });
+		_preparedSize += int64(size.width()) * size.height() * 4;
+	}
+	decodeNext();
+}
+
+void Prefetcher::clear() {
+	if (_hits || _misses) {
+		DEBUG_LOG(("MediaView Info: prefetched %1 of %2 shown photos.").arg(_hits).arg(_hits + _misses));
+	}
+	_hits = _misses = 0;
+	_requests.clear();
+	_downloading.clear();
+	_prepared.clear();
+	_preparedSize = 0;
+	_fastMoves = 0;
+	_lastDelta = 0;
+}
+
+} // namespace View
+} // namespace Media
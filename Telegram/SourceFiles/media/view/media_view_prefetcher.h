@@ -0,0 +1,72 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+#include "base/flat_hash_map.h"
+
+namespace Media {
+namespace View {
+
+// Downloads and prepares the photos the viewer is going to show next.
+//
+// The photos are decoded and scaled to the size they are shown in on
+// background threads, while the total size of the prepared images fits
+// in a memory budget. Each prefetch() call replaces the wanted photos,
+// the prepared images and the downloads started here for the photos
+// that are not wanted anymore are dropped.
+class Prefetcher : public base::has_weak_ptr {
+public:
+	struct Request {
+		not_null<PhotoData*> photo;
+		QSize size; // In pixels.
+	};
+
+	// How many items to preload in the direction of the move by delta,
+	// more if the user is moving fast in one direction.
+	int preloadCount(int delta);
+
+	// Requests are ordered from the most wanted one.
+	void prefetch(std::vector<Request> &&requests);
+	void checkLoaded();
+
+	// Returns a null pixmap if the photo was not prepared in that size.
+	QPixmap take(not_null<PhotoData*> photo, QSize size);
+
+	void clear();
+
+private:
+	struct Prepared {
+		QSize size;
+		QPixmap pixmap;
+	};
+
+	bool wanted(not_null<PhotoData*> photo) const;
+	void decodeNext();
+	void decodeDone(
+		not_null<PhotoData*> photo,
+		QSize size,
+		QImage &&image);
+
+	int _lastDelta = 0;
+	TimeMs _lastMoveTime = 0;
+	int _fastMoves = 0;
+
+	std::vector<Request> _requests;
+	base::flat_set<not_null<PhotoData*>> _downloading;
+	base::flat_hash_map<PhotoData*, Prepared> _prepared;
+	PhotoData *_decoding = nullptr;
+	int64 _preparedSize = 0;
+
+	int _hits = 0;
+	int _misses = 0;
+
+};
+
+} // namespace View
+} // namespace Media
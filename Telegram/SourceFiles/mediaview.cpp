@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/media_clip_reader.h"
 #include "media/view/media_clip_controller.h"
 #include "media/view/media_view_group_thumbs.h"
+#include "media/view/media_view_prefetcher.h"
 #include "media/media_audio.h"
 #include "history/history_message.h"
 #include "history/history_media_types.h"
@@ -33,8 +34,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
-constexpr auto kPreloadCount = 4;
-
 // Preload X message ids before and after current.
 constexpr auto kIdsLimit = 48;
 
@@ -70,7 +69,8 @@ MediaView::MediaView()
 , _lastAction(-st::mediaviewDeltaFromLastAction, -st::mediaviewDeltaFromLastAction)
 , _a_state(animation(this, &MediaView::step_state))
 , _dropdown(this, st::mediaviewDropdownMenu)
-, _dropdownShowTimer(this) {
+, _dropdownShowTimer(this)
+, _prefetcher(std::make_unique<Media::View::Prefetcher>()) {
 	subscribe(Lang::Current().updated(), [this] { refreshLang(); });
 
 	TextCustomTagsMap custom;
@@ -87,6 +87,7 @@ MediaView::MediaView()
 			subscribe(Auth().downloaderTaskFinished(), [this] {
 				if (!isHidden()) {
 					updateControls();
+					_prefetcher->checkLoaded();
 				}
 			});
 			subscribe(Auth().calls().currentCallChanged(), [this](Calls::Call *call) {
@@ -681,6 +682,7 @@ void MediaView::clearData() {
 	_doc = nullptr;
 	_fullScreenVideo = false;
 	_caption.clear();
+	_prefetcher->clear();
 }
 
 MediaView::~MediaView() {
@@ -1410,19 +1412,12 @@ void MediaView::displayPhoto(not_null<PhotoData*> photo, HistoryItem *item) {
 	_full = -1;
 	_current = QPixmap();
 	_down = OverNone;
-	_w = convertScale(photo->full->width());
-	_h = convertScale(photo->full->height());
 	if (isHidden()) {
 		moveToScreen();
 	}
-	if (_w > width()) {
-		_h = qRound(_h * width() / float64(_w));
-		_w = width();
-	}
-	if (_h > height()) {
-		_w = qRound(_w * height() / float64(_h));
-		_h = height();
-	}
+	const auto size = photoFitSize(photo);
+	_w = size.width();
+	_h = size.height();
 	_x = (width() - _w) / 2;
 	_y = (height() - _h) / 2;
 	_width = _w;
@@ -1470,7 +1465,7 @@ void MediaView::displayDocument(DocumentData *doc, HistoryItem *item) { // empty
 	}
 	if (_doc) {
 		if (_doc->sticker()) {
-			_doc->checkSticker();
+			_doc->checkStickerNow();
 			if (!_doc->sticker()->img->isNull()) {
 				_current = _doc->sticker()->img->pix();
 			} else {
@@ -1933,19 +1928,20 @@ void MediaView::paintEvent(QPaintEvent *e) {
 
 	// photo
 	if (_photo) {
-		int32 w = _width * cIntRetinaFactor();
+		const auto size = photoPixSize(_photo, _width);
+		const auto w = size.width(), h = size.height();
 		if (_full <= 0 && _photo->loaded()) {
-			int32 h = int((_photo->full->height() * (qreal(w) / qreal(_photo->full->width()))) + 0.9999);
-			_current = _photo->full->pixNoCache(w, h, Images::Option::Smooth);
+			_current = _prefetcher->take(_photo, size);
+			if (_current.isNull()) {
+				_current = _photo->full->pixNoCache(w, h, Images::Option::Smooth);
+			}
 			if (cRetina()) _current.setDevicePixelRatio(cRetinaFactor());
 			_full = 1;
 		} else if (_full < 0 && _photo->medium->loaded()) {
-			int32 h = int((_photo->full->height() * (qreal(w) / qreal(_photo->full->width()))) + 0.9999);
 			_current = _photo->medium->pixNoCache(w, h, Images::Option::Smooth | Images::Option::Blurred);
 			if (cRetina()) _current.setDevicePixelRatio(cRetinaFactor());
 			_full = 0;
 		} else if (_current.isNull() && _photo->thumb->loaded()) {
-			int32 h = int((_photo->full->height() * (qreal(w) / qreal(_photo->full->width()))) + 0.9999);
 			_current = _photo->thumb->pixNoCache(w, h, Images::Option::Smooth | Images::Option::Blurred);
 			if (cRetina()) _current.setDevicePixelRatio(cRetinaFactor());
 		} else if (_current.isNull()) {
@@ -2533,8 +2529,9 @@ void MediaView::preloadData(int delta) {
 	if (!_index) {
 		return;
 	}
+	const auto count = _prefetcher->preloadCount(delta);
 	auto from = *_index + (delta ? delta : -1);
-	auto till = *_index + (delta ? delta * kPreloadCount : 1);
+	auto till = *_index + (delta ? delta * count : 1);
 	if (from > till) std::swap(from, till);
 
 	if (delta != 0) {
@@ -2547,10 +2544,18 @@ void MediaView::preloadData(int delta) {
 		}
 	}
 
-	for (auto index = from; index != till; ++index) {
+	// Photos are prefetched starting from the nearest one in the
+	// direction of the move. The current one is decoded by the paint
+	// right away, so it is not prefetched.
+	auto photos = std::vector<Media::View::Prefetcher::Request>();
+	for (auto i = 0; i != till - from; ++i) {
+		const auto index = (delta < 0) ? (till - 1 - i) : (from + i);
 		auto entity = entityByIndex(index);
 		if (auto photo = base::get_if<not_null<PhotoData*>>(&entity.data)) {
-			(*photo)->download();
+			if (photo->get() != _photo) {
+				const auto size = photoFitSize(*photo);
+				photos.push_back({ *photo, photoPixSize(*photo, size.width()) });
+			}
 		} else if (auto document = base::get_if<not_null<DocumentData*>>(&entity.data)) {
 			if (auto sticker = (*document)->sticker()) {
 				sticker->img->load();
@@ -2560,6 +2565,31 @@ void MediaView::preloadData(int delta) {
 			}
 		}
 	}
+	_prefetcher->prefetch(std::move(photos));
+}
+
+QSize MediaView::photoFitSize(not_null<PhotoData*> photo) const {
+	auto w = convertScale(photo->full->width());
+	auto h = convertScale(photo->full->height());
+	if (w > width()) {
+		h = qRound(h * width() / float64(w));
+		w = width();
+	}
+	if (h > height()) {
+		w = qRound(w * height() / float64(h));
+		h = height();
+	}
+	return QSize(w, h);
+}
+
+QSize MediaView::photoPixSize(not_null<PhotoData*> photo, int fitWidth) const {
+	const auto fullWidth = photo->full->width();
+	if (fitWidth <= 0 || fullWidth <= 0) {
+		return QSize();
+	}
+	const auto w = fitWidth * cIntRetinaFactor();
+	const auto h = int((photo->full->height() * (qreal(w) / qreal(fullWidth))) + 0.9999);
+	return QSize(w, h);
 }
 
 void MediaView::mousePressEvent(QMouseEvent *e) {
@@ -21,6 +21,7 @@ class Controller;
 } // namespace Clip
 namespace View {
 class GroupThumbs;
+class Prefetcher;
 } // namespace View
 } // namespace Media
 
@@ -139,6 +140,8 @@ private:
 	void moveToScreen();
 	bool moveToNext(int delta);
 	void preloadData(int delta);
+	QSize photoFitSize(not_null<PhotoData*> photo) const;
+	QSize photoPixSize(not_null<PhotoData*> photo, int fitWidth) const;
 	struct Entity {
 		base::optional_variant<
 			not_null<PhotoData*>,
@@ -361,6 +364,7 @@ private:
 	Ui::PopupMenu *_menu = nullptr;
 	object_ptr<Ui::DropdownMenu> _dropdown;
 	object_ptr<QTimer> _dropdownShowTimer;
+	std::unique_ptr<Media::View::Prefetcher> _prefetcher;
 
 	struct ActionData {
 		QString text;
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_photo.h"
 #include "data/data_document.h"
 #include "base/timer.h"
+#include "core/startup_trace.h"
 #include "storage/localstorage.h"
 #include "platform/platform_specific.h"
 #include "mainwindow.h"
@@ -46,6 +47,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace {
 
 constexpr auto kQuitPreventTimeoutMs = 1500;
+constexpr auto kStartupTraceTimeoutMs = 60 * 1000;
 
 Messenger *SingleInstance = nullptr;
 
@@ -76,6 +78,8 @@ Messenger::Messenger(not_null<Core::Launcher*> launcher)
 	Expects(SingleInstance == nullptr);
 	SingleInstance = this;
 
+	StartupTrace::Span trace("Messenger::Messenger");
+
 	Fonts::Start();
 
 	ThirdParty::start();
@@ -101,7 +105,10 @@ Messenger::Messenger(not_null<Core::Launcher*> launcher)
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
 
-	style::startManager();
+	{
+		StartupTrace::Span trace("style::startManager");
+		style::startManager();
+	}
 	anim::startManager();
 	Ui::InitTextOptions();
 	Media::Player::start();
@@ -119,8 +126,11 @@ Messenger::Messenger(not_null<Core::Launcher*> launcher)
 	// Create mime database, so it won't be slow later.
 	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
 
-	_window = std::make_unique<MainWindow>();
-	_window->init();
+	{
+		StartupTrace::Span trace("MainWindow::init");
+		_window = std::make_unique<MainWindow>();
+		_window->init();
+	}
 
 	auto currentGeometry = _window->geometry();
 	_mediaView = std::make_unique<MediaView>();
@@ -143,6 +153,7 @@ Messenger::Messenger(not_null<Core::Launcher*> launcher)
 		DEBUG_LOG(("Application Info: passcode needed..."));
 	} else {
 		DEBUG_LOG(("Application Info: local map read..."));
+		StartupTrace::Span trace("Messenger::startMtp");
 		startMtp();
 	}
 
@@ -152,13 +163,26 @@ Messenger::Messenger(not_null<Core::Launcher*> launcher)
 	if (state == Local::ReadMapPassNeeded) {
 		setupPasscode();
 	} else {
+		StartupTrace::Span trace("MainWindow::setup");
 		if (AuthSession::Exists()) {
 			_window->setupMain();
 		} else {
 			_window->setupIntro();
 		}
 	}
-	_window->firstShow();
+	{
+		StartupTrace::Span trace("MainWindow::firstShow");
+		_window->firstShow();
+	}
+	if (state == Local::ReadMapPassNeeded || !AuthSession::Exists()) {
+		InvokeQueued(this, [] { StartupTrace::Finish(); });
+	} else {
+		// Usually finished earlier in MainWidget::start().
+		App::CallDelayed(
+			kStartupTraceTimeoutMs,
+			this,
+			[] { StartupTrace::Finish(); });
+	}
 
 	if (cStartToSettings()) {
 		_window->showSettings();
@@ -469,7 +493,10 @@ void Messenger::destroyStaleAuthorizationKeys() {
 void Messenger::startLocalStorage() {
 	_dcOptions = std::make_unique<MTP::DcOptions>();
 	_dcOptions->constructFromBuiltIn();
-	Local::start();
+	{
+		StartupTrace::Span trace("Local::start");
+		Local::start();
+	}
 	subscribe(_dcOptions->changed(), [this](const MTP::DcOptions::Ids &ids) {
 		Local::writeSettings();
 		if (auto instance = mtp()) {
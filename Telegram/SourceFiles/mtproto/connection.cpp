@@ -33,6 +33,9 @@ constexpr auto kMaxModExpSize = 256;
 // Don't try to handle messages larger than this size.
 constexpr auto kMaxMessageLength = 16 * 1024 * 1024;
 
+// Log the sent packets statistics once in that many packets.
+constexpr auto kSentStatsPeriod = 100;
+
 QString LogIdsVector(const QVector<MTPlong> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(ids.cbegin()->v);
@@ -794,6 +797,7 @@ void ConnectionPrivate::tryToSend() {
 
 	bool needAnyResponse = false;
 	mtpRequest toSendRequest;
+	auto sentRequestsCount = 0;
 	{
 		QWriteLocker locker1(sessionData->toSendMutex());
 
@@ -808,6 +812,7 @@ void ConnectionPrivate::tryToSend() {
 		if (httpWaitRequest) ++toSendCount;
 
 		if (!toSendCount) return; // nothing to send
+		sentRequestsCount = toSendCount;
 
 		mtpRequest first = pingRequest ? pingRequest : (ackRequest ? ackRequest : (resendRequest ? resendRequest : (stateRequest ? stateRequest : (httpWaitRequest ? httpWaitRequest : toSend.cbegin().value()))));
 		if (toSendCount == 1 && first->msDate > 0) { // if can send without container
@@ -961,9 +966,19 @@ void ConnectionPrivate::tryToSend() {
 		}
 	}
 	mtpRequestData::padding(toSendRequest);
+	countSentPacket(sentRequestsCount, toSendRequest->size() * kIntSize);
 	sendRequest(toSendRequest, needAnyResponse, lockFinished);
 }
 
+void ConnectionPrivate::countSentPacket(int requestsCount, int bytes) {
+	++_sentPackets;
+	_sentRequests += requestsCount;
+	_sentBytes += bytes;
+	if (!(_sentPackets % kSentStatsPeriod)) {
+		DEBUG_LOG(("MTP Info: dc %1 sent %2 requests in %3 packets, %4 bytes per request").arg(getShiftedDcId()).arg(_sentRequests).arg(_sentPackets).arg(_sentBytes / _sentRequests));
+	}
+}
+
 void ConnectionPrivate::retryByTimer() {
 	QReadLocker lockFinished(&sessionDataMutex);
 	if (!sessionData) return;
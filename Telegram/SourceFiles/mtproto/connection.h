@@ -222,6 +222,11 @@ private:
 	mtpMsgId _pingMsgId = 0;
 	SingleTimer _pingSender;
 
+	void countSentPacket(int requestsCount, int bytes);
+	int64 _sentPackets = 0;
+	int64 _sentRequests = 0;
+	int64 _sentBytes = 0;
+
 	void resend(quint64 msgId, qint64 msCanWait = 0, bool forceContainer = false, bool sendMsgStateInfo = false);
 	void resendMany(QVector<quint64> msgIds, qint64 msCanWait = 0, bool forceContainer = false, bool sendMsgStateInfo = false);
 
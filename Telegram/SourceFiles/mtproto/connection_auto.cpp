@@ -118,9 +118,7 @@ void AutoConnection::sendData(mtpBuffer &buffer) {
 void AutoConnection::httpSend(mtpBuffer &buffer) {
 	int32 requestSize = (buffer.size() - 3) * sizeof(mtpPrime);
 
-	QNetworkRequest request(address);
-	request.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(requestSize));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(qsl("application/x-www-form-urlencoded")));
+	auto request = HTTPConnection::prepareRequest(address, requestSize);
 
 	TCP_LOG(("HTTP Info: sending %1 len request").arg(requestSize));
 	requests.insert(manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)));
@@ -290,7 +288,9 @@ bool AutoConnection::usingHttpWait() {
 }
 
 bool AutoConnection::needHttpWait() {
-	return (status == UsingHttp) ? requests.isEmpty() : false;
+	return (status == UsingHttp)
+		? (requests.size() < HTTPConnection::kConcurrentRequests)
+		: false;
 }
 
 int32 AutoConnection::debugState() const {
@@ -10,6 +10,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace MTP {
 namespace internal {
 
+QNetworkRequest HTTPConnection::prepareRequest(const QUrl &address, int32 size) {
+	auto result = QNetworkRequest(address);
+	result.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(size));
+	result.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(qsl("application/x-www-form-urlencoded")));
+
+	// The protocol responses are never cached.
+	result.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+	result.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+	return result;
+}
+
 mtpBuffer HTTPConnection::handleResponse(QNetworkReply *reply) {
 	QByteArray response = reply->readAll();
 	TCP_LOG(("HTTP Info: read %1 bytes").arg(response.size()));
@@ -94,9 +105,7 @@ void HTTPConnection::sendData(mtpBuffer &buffer) {
 
 	int32 requestSize = (buffer.size() - 3) * sizeof(mtpPrime);
 
-	QNetworkRequest request(address);
-	request.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(requestSize));
-	request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(qsl("application/x-www-form-urlencoded")));
+	auto request = prepareRequest(address, requestSize);
 
 	TCP_LOG(("HTTP Info: sending %1 len request %2").arg(requestSize).arg(Logs::mb(&buffer[2], requestSize).str()));
 	requests.insert(manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)));
@@ -181,7 +190,7 @@ bool HTTPConnection::usingHttpWait() {
 }
 
 bool HTTPConnection::needHttpWait() {
-	return requests.isEmpty();
+	return (requests.size() < kConcurrentRequests);
 }
 
 int32 HTTPConnection::debugState() const {
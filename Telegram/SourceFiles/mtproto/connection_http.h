@@ -31,9 +31,15 @@ public:
 
 	QString transport() const override;
 
+	static QNetworkRequest prepareRequest(const QUrl &address, int32 size);
 	static mtpBuffer handleResponse(QNetworkReply *reply);
 	static qint32 handleError(QNetworkReply *reply); // returnes error code
 
+	// Each request carries http_wait, so the server holds it until it has
+	// something to send. While the response to one of them is processed
+	// the other one is still waiting on the server.
+	static constexpr auto kConcurrentRequests = 2;
+
 public slots:
 	void requestFinished(QNetworkReply *reply);
 
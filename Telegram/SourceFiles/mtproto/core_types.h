@@ -17,6 +17,15 @@ namespace MTP {
 using DcId = int32;
 using ShiftedDcId = int32;
 
+// Interactive requests are sent right away, the visible content ones
+// may be collected with others for a moment and the background ones
+// wait for other requests a bit longer, but never too long.
+enum class RequestPriority {
+	Interactive,
+	Visible,
+	Background,
+};
+
 } // namespace MTP
 
 using mtpPrime = int32;
@@ -51,6 +60,7 @@ public:
 	mtpRequestId requestId = 0;
 	mtpRequest after;
 	bool needsLayer = false;
+	MTP::RequestPriority priority = MTP::RequestPriority::Visible;
 
 	mtpRequestData(bool/* sure*/) {
 	}
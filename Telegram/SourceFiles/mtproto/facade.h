@@ -184,8 +184,9 @@ inline mtpRequestId send(
 		RPCResponseHandler &&callbacks = {},
 		ShiftedDcId dcId = 0,
 		TimeMs msCanWait = 0,
-		mtpRequestId after = 0) {
-	return MainInstance()->send(request, std::move(callbacks), dcId, msCanWait, after);
+		mtpRequestId after = 0,
+		RequestPriority priority = RequestPriority::Visible) {
+	return MainInstance()->send(request, std::move(callbacks), dcId, msCanWait, after, priority);
 }
 
 template <typename TRequest>
@@ -195,8 +196,9 @@ inline mtpRequestId send(
 		RPCFailHandlerPtr &&onFail = nullptr,
 		ShiftedDcId dcId = 0,
 		TimeMs msCanWait = 0,
-		mtpRequestId after = 0) {
-	return MainInstance()->send(request, std::move(onDone), std::move(onFail), dcId, msCanWait, after);
+		mtpRequestId after = 0,
+		RequestPriority priority = RequestPriority::Visible) {
+	return MainInstance()->send(request, std::move(onDone), std::move(onFail), dcId, msCanWait, after, priority);
 }
 
 inline void sendAnything(ShiftedDcId shiftedDcId = 0, TimeMs msCanWait = 0) {
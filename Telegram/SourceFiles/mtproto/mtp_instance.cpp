@@ -1470,7 +1470,8 @@ mtpRequestId Instance::send(
 		RPCResponseHandler &&callbacks,
 		ShiftedDcId dcId,
 		TimeMs msCanWait,
-		mtpRequestId after) {
+		mtpRequestId after,
+		RequestPriority priority) {
 	if (const auto session = _private->getSession(dcId)) {
 		return session->send(
 			mtpRequestData::serialize(request),
@@ -1478,7 +1479,8 @@ mtpRequestId Instance::send(
 			msCanWait,
 			true,
 			!dcId,
-			after);
+			after,
+			priority);
 	}
 	return 0;
 }
@@ -64,13 +64,15 @@ public:
 			RPCResponseHandler &&callbacks = {},
 			ShiftedDcId dcId = 0,
 			TimeMs msCanWait = 0,
-			mtpRequestId after = 0) {
+			mtpRequestId after = 0,
+			RequestPriority priority = RequestPriority::Visible) {
 		return send(
 			mtpRequestData::serialize(request),
 			std::move(callbacks),
 			dcId,
 			msCanWait,
-			after);
+			after,
+			priority);
 	}
 
 	template <typename TRequest>
@@ -80,13 +82,15 @@ public:
 			RPCFailHandlerPtr &&onFail = nullptr,
 			ShiftedDcId dc = 0,
 			TimeMs msCanWait = 0,
-			mtpRequestId after = 0) {
+			mtpRequestId after = 0,
+			RequestPriority priority = RequestPriority::Visible) {
 		return send(
 			request,
 			RPCResponseHandler(std::move(onDone), std::move(onFail)),
 			dc,
 			msCanWait,
-			after);
+			after,
+			priority);
 	}
 
 	void sendAnything(ShiftedDcId dcId = 0, TimeMs msCanWait = 0);
@@ -157,7 +161,8 @@ private:
 		RPCResponseHandler &&callbacks,
 		ShiftedDcId dcId,
 		TimeMs msCanWait,
-		mtpRequestId after);
+		mtpRequestId after,
+		RequestPriority priority);
 
 	class Private;
 	const std::unique_ptr<Private> _private;
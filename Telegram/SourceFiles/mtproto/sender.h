@@ -148,6 +148,9 @@ class Sender {
 		void setAfter(mtpRequestId requestId) noexcept {
 			_afterRequestId = requestId;
 		}
+		void setPriority(RequestPriority priority) noexcept {
+			_priority = priority;
+		}
 
 		ShiftedDcId takeDcId() const noexcept {
 			return _dcId;
@@ -169,6 +172,9 @@ class Sender {
 		mtpRequestId takeAfter() const noexcept {
 			return _afterRequestId;
 		}
+		RequestPriority takePriority() const noexcept {
+			return _priority;
+		}
 
 		not_null<Sender*> sender() const noexcept {
 			return _sender;
@@ -185,6 +191,7 @@ class Sender {
 		base::variant<FailPlainHandler, FailRequestIdHandler> _fail;
 		FailSkipPolicy _failSkipPolicy = FailSkipPolicy::Simple;
 		mtpRequestId _afterRequestId = 0;
+		RequestPriority _priority = RequestPriority::Visible;
 
 	};
 
@@ -237,6 +244,10 @@ public:
 			setAfter(requestId);
 			return *this;
 		}
+		[[nodiscard]] SpecificRequestBuilder &priority(RequestPriority priority) noexcept {
+			setPriority(priority);
+			return *this;
+		}
 
 		mtpRequestId send() {
 			const auto id = MainInstance()->send(
@@ -245,7 +256,8 @@ public:
 				takeOnFail(),
 				takeDcId(),
 				takeCanWait(),
-				takeAfter());
+				takeAfter(),
+				takePriority());
 			registerRequest(id);
 			return id;
 		}
@@ -16,6 +16,15 @@ namespace MTP {
 namespace internal {
 namespace {
 
+// Requests that can't wait are still collected until the end of the
+// current event loop iteration unless they already make a container
+// of that size, so that a burst of requests goes in one packet.
+constexpr auto kCoalesceSendSize = 16 * 1024;
+
+// Background requests wait that long for other requests to go with,
+// but they are not delayed more than that by the newer requests.
+constexpr auto kBackgroundCanWait = TimeMs(100);
+
 QString LogIds(const QVector<uint64> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(*ids.cbegin());
@@ -199,6 +208,12 @@ void Session::sendAnything(qint64 msCanWait) {
 		DEBUG_LOG(("MTP Info: dcWithShift %1 can wait for %2ms from current %3").arg(dcWithShift).arg(msWait).arg(msSendCall));
 		msSendCall = ms;
 		sender.start(msWait);
+	} else if (!_interactiveQueued
+		&& _coalescedSize > 0
+		&& _coalescedSize < kCoalesceSendSize) {
+		DEBUG_LOG(("MTP Info: dcWithShift %1 coalescing %2 bytes to send").arg(dcWithShift).arg(_coalescedSize));
+		msSendCall = ms;
+		sender.start(0);
 	} else {
 		DEBUG_LOG(("MTP Info: dcWithShift %1 stopped send timer, can wait for %2ms from current %3").arg(dcWithShift).arg(msWait).arg(msSendCall));
 		sender.stop();
@@ -212,6 +227,8 @@ void Session::needToResumeAndSend() {
 		DEBUG_LOG(("Session Info: can't resume a killed session"));
 		return;
 	}
+	_coalescedSize = 0;
+	_interactiveQueued = false;
 	if (!_connection) {
 		DEBUG_LOG(("Session Info: resuming session dcWithShift %1").arg(dcWithShift));
 		createDcData();
@@ -465,11 +482,13 @@ mtpRequestId Session::send(
 		TimeMs msCanWait,
 		bool needsLayer,
 		bool toMainDC,
-		mtpRequestId after) {
+		mtpRequestId after,
+		RequestPriority priority) {
 	DEBUG_LOG(("MTP Info: adding request to toSendMap, msCanWait %1").arg(msCanWait));
 
 	request->msDate = getms(true); // > 0 - can send without container
 	request->needsLayer = needsLayer;
+	request->priority = priority;
 	if (after) {
 		request->after = getRequest(after);
 	}
@@ -493,9 +512,21 @@ void Session::sendPrepared(const mtpRequest &request, TimeMs msCanWait, bool new
 			*(request->data() + 6) = 0;
 		}
 	}
+	_coalescedSize += request->size() * sizeof(mtpPrime);
 
 	DEBUG_LOG(("MTP Info: added, requestId %1").arg(request->requestId));
 
+	switch (request->priority) {
+	case RequestPriority::Interactive:
+		_interactiveQueued = true;
+		msCanWait = 0;
+		break;
+	case RequestPriority::Visible:
+		break;
+	case RequestPriority::Background:
+		accumulate_max(msCanWait, kBackgroundCanWait);
+		break;
+	}
 	sendAnything(msCanWait);
 }
 
@@ -310,7 +310,8 @@ public:
 		TimeMs msCanWait = 0,
 		bool needsLayer = false,
 		bool toMainDC = false,
-		mtpRequestId after = 0);
+		mtpRequestId after = 0,
+		RequestPriority priority = RequestPriority::Visible);
 
 	// Nulls msgId and seqNo in request, if newRequest = true.
 	void sendPrepared(
@@ -368,6 +369,8 @@ private:
 
 	TimeMs msSendCall = 0;
 	TimeMs msWait = 0;
+	int _coalescedSize = 0;
+	bool _interactiveQueued = false;
 
 	bool _ping = false;
 
@@ -346,6 +346,11 @@ HistoryTextState Photo::getState(
 	return {};
 }
 
+void Photo::clearHeavyPart() {
+	_pix = QPixmap();
+	_data->forget();
+}
+
 Video::Video(
 	not_null<HistoryItem*> parent,
 	not_null<DocumentData*> video)
@@ -507,6 +512,11 @@ HistoryTextState Video::getState(
 	return {};
 }
 
+void Video::clearHeavyPart() {
+	_pix = QPixmap();
+	_data->thumb->forget();
+}
+
 void Video::updateStatusText() {
 	bool showPause = false;
 	int statusSize = 0;
@@ -1086,6 +1096,11 @@ HistoryTextState Document::getState(
 	return {};
 }
 
+void Document::clearHeavyPart() {
+	_thumb = QPixmap();
+	_data->thumb->forget();
+}
+
 const style::RoundCheckbox &Document::checkboxStyle() const {
 	return st::overviewSmallCheck;
 }
@@ -1438,6 +1453,12 @@ HistoryTextState Link::getState(
 	return {};
 }
 
+void Link::clearHeavyPart() {
+	if (_page) {
+		_page->forget();
+	}
+}
+
 const style::RoundCheckbox &Link::checkboxStyle() const {
 	return st::overviewSmallCheck;
 }
@@ -55,6 +55,11 @@ public:
 	virtual void invalidateCache() {
 	}
 
+	// Releases cached pixmaps and decoded images, they are
+	// prepared again on the next paint() call.
+	virtual void clearHeavyPart() {
+	}
+
 };
 
 class ItemBase : public AbstractItem {
@@ -201,6 +206,8 @@ public:
 		QPoint point,
 		HistoryStateRequest request) const override;
 
+	void clearHeavyPart() override;
+
 private:
 	not_null<PhotoData*> _data;
 	ClickHandlerPtr _link;
@@ -223,6 +230,8 @@ public:
 		QPoint point,
 		HistoryStateRequest request) const override;
 
+	void clearHeavyPart() override;
+
 protected:
 	float64 dataProgress() const override;
 	bool dataFinished() const override;
@@ -293,6 +302,8 @@ public:
 		return _data;
 	}
 
+	void clearHeavyPart() override;
+
 protected:
 	float64 dataProgress() const override;
 	bool dataFinished() const override;
@@ -333,6 +344,8 @@ public:
 		QPoint point,
 		HistoryStateRequest request) const override;
 
+	void clearHeavyPart() override;
+
 protected:
 	const style::RoundCheckbox &checkboxStyle() const override;
 
@@ -130,9 +130,10 @@ QPixmap FileLoader::imagePixmap(const QSize &shrinkBox) const {
 
 void FileLoader::readImage(const QSize &shrinkBox) const {
 	auto format = QByteArray();
-	auto image = App::readImage(_data, &format, false);
+	auto image = App::readImage(_data, &format, false, nullptr, shrinkBox);
 	if (!image.isNull()) {
 		if (!shrinkBox.isEmpty() && (image.width() > shrinkBox.width() || image.height() > shrinkBox.height())) {
+			// The image format didn't support the scaled decoding.
 			_imagePixmap = App::pixmapFromImageInPlace(image.scaled(shrinkBox, Qt::KeepAspectRatio, Qt::SmoothTransformation));
 		} else {
 			_imagePixmap = App::pixmapFromImageInPlace(std::move(image));
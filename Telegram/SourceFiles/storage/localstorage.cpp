@@ -26,8 +26,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "auth_session.h"
 #include "window/window_controller.h"
 #include "base/flags.h"
+#include "core/startup_trace.h"
 
 #include <openssl/evp.h>
+#include <atomic>
+#include <deque>
 
 namespace Local {
 namespace {
@@ -35,6 +38,14 @@ namespace {
 constexpr auto kThemeFileSizeLimit = 5 * 1024 * 1024;
 constexpr auto kFileLoaderQueueStopTimeout = TimeMs(5000);
 
+// Large cached files are encrypted in independently keyed chunks,
+// so that they can be decrypted on several threads at once. Each chunk
+// starts with the random file id, its index, the chunks count and the
+// total data size, so chunks can't be dropped or mixed between files.
+constexpr auto kEncryptedChunkSize = 256 * 1024;
+constexpr auto kEncryptedChunksMarker = quint32(0x43464454U); // "TDFC"
+constexpr auto kEncryptedChunkPrefixSize = int(sizeof(quint64) + 3 * sizeof(quint32));
+
 using FileKey = quint64;
 
 constexpr char tdfMagic[] = { 'T', 'D', 'F', '$' };
@@ -137,6 +148,7 @@ auto PassKey = MTP::AuthKeyPtr();
 auto LocalKey = MTP::AuthKeyPtr();
 
 void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *result) {
+	StartupTrace::Span trace("Local::createLocalKey");
 	auto key = MTP::AuthKey::Data { { gsl::byte{} } };
 	auto iterCount = pass.size() ? LocalEncryptIterCount : LocalEncryptNoPwdIterCount; // dont slow down for no password
 	auto newSalt = QByteArray();
@@ -195,6 +207,43 @@ struct EncryptedDescriptor {
 	}
 };
 
+// Calls callback(index) for every index in [0, count) on the calling
+// thread and on the thread pool and waits for all of them to finish.
+// The calling thread takes indices as well and waits only for the ones
+// that are already being processed, so it is safe to call from a pool
+// task: the pool tasks that didn't start in time are not waited for.
+template <typename Callback>
+void InvokeInParallel(int count, Callback callback) {
+	if (count < 2) {
+		for (auto i = 0; i != count; ++i) {
+			callback(i);
+		}
+		return;
+	}
+	struct State {
+		std::atomic<int> next{ 0 };
+		QSemaphore done;
+	};
+	const auto state = std::make_shared<State>();
+	const auto invoke = &callback;
+	const auto work = [=] {
+		auto invoked = 0;
+		for (auto i = state->next++; i < count; i = state->next++) {
+			(*invoke)(i);
+			++invoked;
+		}
+		return invoked;
+	};
+	for (auto i = 1; i != count; ++i) {
+		crl::async([=] {
+			if (const auto invoked = work()) {
+				state->done.release(invoked);
+			}
+		});
+	}
+	state->done.acquire(count - work());
+}
+
 struct FileWriteDescriptor {
 	FileWriteDescriptor(const FileKey &key, FileOptions options = FileOption::User | FileOption::Safe) {
 		init(toFilePart(key), options);
@@ -276,6 +325,46 @@ struct FileWriteDescriptor {
 	bool writeEncrypted(EncryptedDescriptor &data, const MTP::AuthKeyPtr &key = LocalKey) {
 		return writeData(prepareEncrypted(data, key));
 	}
+
+	// Writes a plain header followed by kEncryptedChunkSize parts of data
+	// each encrypted as a separate block, read by readEncryptedFile().
+	bool writeEncryptedChunked(EncryptedDescriptor &data, const MTP::AuthKeyPtr &key = LocalKey) {
+		data.finish();
+		const auto size = int(data.data.size() - sizeof(uint32));
+		if (size <= kEncryptedChunkSize) {
+			return writeEncrypted(data, key);
+		}
+		const auto count = (size + kEncryptedChunkSize - 1) / kEncryptedChunkSize;
+		const auto fileId = rand_value<quint64>();
+		const quint32 header[] = {
+			kEncryptedChunksMarker,
+			quint32(kEncryptedChunkSize),
+			quint32(count),
+		};
+		if (!writeData(QByteArray(reinterpret_cast<const char*>(header), sizeof(header)))) {
+			return false;
+		}
+
+		auto encrypted = std::vector<QByteArray>(count);
+		InvokeInParallel(count, [&](int index) {
+			const auto offset = sizeof(uint32) + index * kEncryptedChunkSize;
+			const auto length = std::min(kEncryptedChunkSize, size - index * kEncryptedChunkSize);
+			EncryptedDescriptor chunk(kEncryptedChunkPrefixSize + length);
+			chunk.stream
+				<< fileId
+				<< quint32(index)
+				<< quint32(count)
+				<< quint32(size);
+			chunk.stream.writeRawData(data.data.constData() + offset, length);
+			encrypted[index] = prepareEncrypted(chunk, key);
+		});
+		for (const auto &part : encrypted) {
+			if (!writeData(part)) {
+				return false;
+			}
+		}
+		return true;
+	}
 	void finish() {
 		if (!file.isOpen()) return;
 
@@ -366,6 +455,7 @@ bool readFile(FileReadDescriptor &result, const QString &name, FileOptions optio
 
 		// read data
 		QByteArray bytes = f.read(f.size());
+		StartupTrace::AddBytesRead(f.pos());
 		int32 dataSize = bytes.size() - 16;
 		if (dataSize < 0) {
 			DEBUG_LOG(("App Info: bad file '%1', could not read sign part").arg(name));
@@ -438,6 +528,88 @@ bool decryptLocal(EncryptedDescriptor &result, const QByteArray &encrypted, cons
 	return true;
 }
 
+bool decryptLocalChunks(EncryptedDescriptor &result, QDataStream &stream, const QByteArray &header, const MTP::AuthKeyPtr &key) {
+	quint32 values[3] = { 0 };
+	memcpy(values, header.constData(), sizeof(values));
+	const auto chunkSize = int(values[1]);
+	const auto count = int(values[2]);
+	const auto available = stream.device()
+		? stream.device()->bytesAvailable()
+		: qint64(0);
+	if (chunkSize != kEncryptedChunkSize
+		|| count <= 0
+		|| count > (available + chunkSize - 1) / chunkSize) {
+		LOG(("App Error: bad encrypted chunks header: %1 x %2").arg(chunkSize).arg(count));
+		return false;
+	}
+
+	auto encrypted = std::vector<QByteArray>(count);
+	for (auto &part : encrypted) {
+		stream >> part;
+	}
+	if (stream.status() != QDataStream::Ok) {
+		LOG(("App Error: could not read %1 encrypted chunks").arg(count));
+		return false;
+	}
+
+	auto decrypted = std::vector<QByteArray>(count);
+	auto fileIds = std::vector<quint64>(count);
+	auto sizes = std::vector<quint32>(count);
+	auto failed = std::atomic<bool>(false);
+	InvokeInParallel(count, [&](int index) {
+		EncryptedDescriptor chunk;
+		quint32 chunkIndex = 0, chunksCount = 0;
+		if (!decryptLocal(chunk, encrypted[index], key)) {
+			failed = true;
+			return;
+		}
+		chunk.stream >> fileIds[index] >> chunkIndex >> chunksCount >> sizes[index];
+		const auto offset = int(sizeof(uint32)) + kEncryptedChunkPrefixSize;
+		const auto length = chunk.data.size() - offset;
+		const auto expected = std::min(
+			qint64(chunkSize),
+			qint64(sizes[index]) - qint64(index) * chunkSize);
+		if (chunk.stream.status() != QDataStream::Ok
+			|| chunkIndex != quint32(index)
+			|| chunksCount != quint32(count)
+			|| length != expected) {
+			failed = true;
+			return;
+		}
+		decrypted[index] = chunk.data.mid(offset);
+	});
+	const auto mixed = [](const auto &values) {
+		return ranges::find_if(values, [&](const auto &value) {
+			return value != values.front();
+		}) != values.end();
+	};
+	if (failed || mixed(fileIds) || mixed(sizes)) {
+		LOG(("App Error: could not decrypt encrypted chunks."));
+		return false;
+	}
+
+	result.data.reserve(sizeof(uint32) + (count - 1) * chunkSize + decrypted.back().size());
+	result.data.resize(sizeof(uint32));
+	for (const auto &part : decrypted) {
+		result.data.append(part);
+	}
+	result.buffer.setBuffer(&result.data);
+	result.buffer.open(QIODevice::ReadOnly);
+	result.buffer.seek(sizeof(uint32)); // skip len
+	result.stream.setDevice(&result.buffer);
+	result.stream.setVersion(QDataStream::Qt_5_1);
+	return true;
+}
+
+bool IsEncryptedChunksHeader(const QByteArray &header) {
+	if (header.size() != int(3 * sizeof(quint32))) {
+		return false;
+	}
+	quint32 marker = 0;
+	memcpy(&marker, header.constData(), sizeof(marker));
+	return (marker == kEncryptedChunksMarker);
+}
+
 bool readEncryptedFile(FileReadDescriptor &result, const QString &name, FileOptions options = FileOption::User | FileOption::Safe, const MTP::AuthKeyPtr &key = LocalKey) {
 	if (!readFile(result, name, options)) {
 		return false;
@@ -446,7 +618,10 @@ bool readEncryptedFile(FileReadDescriptor &result, const QString &name, FileOpti
 	result.stream >> encrypted;
 
 	EncryptedDescriptor data;
-	if (!decryptLocal(data, encrypted, key)) {
+	const auto decrypted = IsEncryptedChunksHeader(encrypted)
+		? decryptLocalChunks(data, result.stream, encrypted, key)
+		: decryptLocal(data, encrypted, key);
+	if (!decrypted) {
 		result.stream.setDevice(0);
 		if (result.buffer.isOpen()) result.buffer.close();
 		result.buffer.setBuffer(0);
@@ -494,6 +669,7 @@ enum { // Local Storage Keys
 	lskStickersKeys = 0x10, // no data
 	lskTrustedBots = 0x11, // no data
 	lskFavedStickers = 0x12, // no data
+	lskVoiceWaveforms = 0x13, // no data
 };
 
 enum {
@@ -601,6 +777,24 @@ using TrustedBots = OrderedSet<uint64>;
 TrustedBots _trustedBots;
 bool _trustedBotsRead = false;
 
+constexpr auto kWaveformWorkersCount = 2;
+constexpr auto kVoiceWaveformsLimit = std::size_t(1024);
+
+struct WaveformRequest {
+	TaskId id = 0;
+	not_null<DocumentData*> document;
+};
+std::deque<WaveformRequest> _waveformRequests;
+base::flat_map<TaskId, not_null<DocumentData*>> _waveformsCounting;
+TaskId _waveformLastId = 0;
+int _waveformWorkers = 0;
+
+// Counted waveforms by document id, encoded with documentWaveformEncode5bit.
+FileKey _voiceWaveformsKey = 0;
+QHash<uint64, QByteArray> _voiceWaveforms;
+std::deque<uint64> _voiceWaveformsOrder;
+bool _voiceWaveformsRead = false;
+
 FileKey _recentStickersKeyOld = 0;
 FileKey _installedStickersKey = 0, _featuredStickersKey = 0, _recentStickersKey = 0, _favedStickersKey = 0, _archivedStickersKey = 0;
 FileKey _savedGifsKey = 0;
@@ -625,6 +819,97 @@ typedef QMap<StorageKey, FileDesc> StorageMap;
 StorageMap _imagesMap, _stickerImagesMap, _audiosMap;
 qint64 _storageImagesSize = 0, _storageStickersSize = 0, _storageAudiosSize = 0;
 
+// Cached file descriptors take most of the map on large profiles, so
+// _readMap() only copies their raw entries and they are parsed on a
+// background thread. Anything that uses the maps calls _ensureStorageMaps()
+// first, it waits for the parsing or does it right away if not started.
+constexpr auto kStorageMapEntrySize = int(3 * sizeof(quint64) + sizeof(qint32));
+
+struct StorageMapsLoading {
+	struct Part {
+		QByteArray entries;
+		StorageMap map;
+		qint64 size = 0;
+	};
+	QMutex mutex;
+	bool parsed = false;
+	Part images, stickerImages, audios;
+};
+std::shared_ptr<StorageMapsLoading> _storageMapsLoading;
+
+void _parseStorageMap(StorageMapsLoading::Part &part) {
+	QDataStream stream(part.entries);
+	stream.setVersion(QDataStream::Qt_5_1);
+	for (auto i = 0, count = part.entries.size() / kStorageMapEntrySize; i != count; ++i) {
+		FileKey key;
+		quint64 first, second;
+		qint32 size;
+		stream >> key >> first >> second >> size;
+		part.map.insert(StorageKey(first, second), FileDesc(key, size));
+		part.size += size;
+	}
+	part.entries = QByteArray();
+}
+
+void _parseStorageMaps(StorageMapsLoading &loading) {
+	if (!loading.parsed) {
+		_parseStorageMap(loading.images);
+		_parseStorageMap(loading.stickerImages);
+		_parseStorageMap(loading.audios);
+		loading.parsed = true;
+	}
+}
+
+void _ensureStorageMaps() {
+	if (!_storageMapsLoading) {
+		return;
+	}
+	const auto loading = base::take(_storageMapsLoading);
+	QMutexLocker lock(&loading->mutex);
+	_parseStorageMaps(*loading);
+	_imagesMap = base::take(loading->images.map);
+	_storageImagesSize = loading->images.size;
+	_stickerImagesMap = base::take(loading->stickerImages.map);
+	_storageStickersSize = loading->stickerImages.size;
+	_audiosMap = base::take(loading->audios.map);
+	_storageAudiosSize = loading->audios.size;
+}
+
+void _startStorageMapsLoading(std::shared_ptr<StorageMapsLoading> loading) {
+	_imagesMap.clear();
+	_stickerImagesMap.clear();
+	_audiosMap.clear();
+	_storageImagesSize = _storageStickersSize = _storageAudiosSize = 0;
+	_storageMapsLoading = loading;
+
+	crl::async([=] {
+		{
+			QMutexLocker lock(&loading->mutex);
+			_parseStorageMaps(*loading);
+		}
+		crl::on_main([=] {
+			if (_storageMapsLoading == loading) {
+				_ensureStorageMaps();
+			}
+		});
+	});
+}
+
+bool _readStorageMapEntries(
+		QDataStream &stream,
+		StorageMapsLoading::Part &part) {
+	quint32 count = 0;
+	stream >> count;
+	const auto already = part.entries.size();
+	if (stream.status() != QDataStream::Ok
+		|| count > quint32((INT_MAX - already) / kStorageMapEntrySize)) {
+		return false;
+	}
+	const auto add = int(count) * kStorageMapEntrySize;
+	part.entries.resize(already + add);
+	return (stream.readRawData(part.entries.data() + already, add) == add);
+}
+
 bool _mapChanged = false;
 int32 _oldMapVersion = 0, _oldSettingsVersion = 0;
 
@@ -643,6 +928,7 @@ AuthSessionData &GetStoredAuthSessionCache() {
 }
 
 void _writeMap(WriteMapWhen when = WriteMapWhen::Soon);
+void _ensureLocationsRead();
 
 void _writeLocations(WriteMapWhen when = WriteMapWhen::Soon) {
 	if (when != WriteMapWhen::Now) {
@@ -651,6 +937,8 @@ void _writeLocations(WriteMapWhen when = WriteMapWhen::Soon) {
 	}
 	if (!_working()) return;
 
+	_ensureLocationsRead();
+
 	_manager->writingLocations();
 	if (_fileLocations.isEmpty() && _webFilesMap.isEmpty()) {
 		if (_locationsKey) {
@@ -728,6 +1016,7 @@ void _writeLocations(WriteMapWhen when = WriteMapWhen::Soon) {
 }
 
 void _readLocations() {
+	StartupTrace::Span trace("Local::readLocations");
 	FileReadDescriptor locations;
 	if (!readEncryptedFile(locations, _locationsKey)) {
 		clearKey(_locationsKey);
@@ -787,6 +1076,16 @@ void _readLocations() {
 	}
 }
 
+// Locations are not needed for the first frame, so they are read
+// from _readMap() only when something accesses them.
+bool _locationsReadPending = false;
+
+void _ensureLocationsRead() {
+	if (base::take(_locationsReadPending) && _locationsKey) {
+		_readLocations();
+	}
+}
+
 void _writeReportSpamStatuses() {
 	if (!_working()) return;
 
@@ -1906,6 +2205,7 @@ void _readMtpData() {
 }
 
 ReadMapState _readMap(const QByteArray &pass) {
+	StartupTrace::Span trace("Local::readMap");
 	auto ms = getms();
 	QByteArray dataNameUtf8 = (cDataFile() + (cTestMode() ? qsl(":/test/") : QString())).toUtf8();
 	FileKey dataNameHash[2];
@@ -1954,9 +2254,9 @@ ReadMapState _readMap(const QByteArray &pass) {
 
 	DraftsMap draftsMap, draftCursorsMap;
 	DraftsNotReadMap draftsNotReadMap;
-	StorageMap imagesMap, stickerImagesMap, audiosMap;
-	qint64 storageImagesSize = 0, storageStickersSize = 0, storageAudiosSize = 0;
+	auto storageMaps = std::make_shared<StorageMapsLoading>();
 	quint64 locationsKey = 0, reportSpamStatusesKey = 0, trustedBotsKey = 0;
+	quint64 voiceWaveformsKey = 0;
 	quint64 recentStickersKeyOld = 0;
 	quint64 installedStickersKey = 0, featuredStickersKey = 0, recentStickersKey = 0, favedStickersKey = 0, archivedStickersKey = 0;
 	quint64 savedGifsKey = 0;
@@ -1987,39 +2287,21 @@ ReadMapState _readMap(const QByteArray &pass) {
 			}
 		} break;
 		case lskImages: {
-			quint32 count = 0;
-			map.stream >> count;
-			for (quint32 i = 0; i < count; ++i) {
-				FileKey key;
-				quint64 first, second;
-				qint32 size;
-				map.stream >> key >> first >> second >> size;
-				imagesMap.insert(StorageKey(first, second), FileDesc(key, size));
-				storageImagesSize += size;
+			if (!_readStorageMapEntries(map.stream, storageMaps->images)) {
+				LOG(("App Error: could not read cached files from map."));
+				return ReadMapFailed;
 			}
 		} break;
 		case lskStickerImages: {
-			quint32 count = 0;
-			map.stream >> count;
-			for (quint32 i = 0; i < count; ++i) {
-				FileKey key;
-				quint64 first, second;
-				qint32 size;
-				map.stream >> key >> first >> second >> size;
-				stickerImagesMap.insert(StorageKey(first, second), FileDesc(key, size));
-				storageStickersSize += size;
+			if (!_readStorageMapEntries(map.stream, storageMaps->stickerImages)) {
+				LOG(("App Error: could not read cached files from map."));
+				return ReadMapFailed;
 			}
 		} break;
 		case lskAudios: {
-			quint32 count = 0;
-			map.stream >> count;
-			for (quint32 i = 0; i < count; ++i) {
-				FileKey key;
-				quint64 first, second;
-				qint32 size;
-				map.stream >> key >> first >> second >> size;
-				audiosMap.insert(StorageKey(first, second), FileDesc(key, size));
-				storageAudiosSize += size;
+			if (!_readStorageMapEntries(map.stream, storageMaps->audios)) {
+				LOG(("App Error: could not read cached files from map."));
+				return ReadMapFailed;
 			}
 		} break;
 		case lskLocations: {
@@ -2062,6 +2344,9 @@ ReadMapState _readMap(const QByteArray &pass) {
 		case lskSavedPeers: {
 			map.stream >> savedPeersKey;
 		} break;
+		case lskVoiceWaveforms: {
+			map.stream >> voiceWaveformsKey;
+		} break;
 		default:
 		LOG(("App Error: unknown key type in encrypted map: %1").arg(keyType));
 		return ReadMapFailed;
@@ -2075,12 +2360,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_draftCursorsMap = draftCursorsMap;
 	_draftsNotReadMap = draftsNotReadMap;
 
-	_imagesMap = imagesMap;
-	_storageImagesSize = storageImagesSize;
-	_stickerImagesMap = stickerImagesMap;
-	_storageStickersSize = storageStickersSize;
-	_audiosMap = audiosMap;
-	_storageAudiosSize = storageAudiosSize;
+	_startStorageMapsLoading(std::move(storageMaps));
 
 	_locationsKey = locationsKey;
 	_reportSpamStatusesKey = reportSpamStatusesKey;
@@ -2096,6 +2376,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_backgroundKey = backgroundKey;
 	_userSettingsKey = userSettingsKey;
 	_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
+	_voiceWaveformsKey = voiceWaveformsKey;
 	_oldMapVersion = mapData.version;
 	if (_oldMapVersion < AppVersion) {
 		_mapChanged = true;
@@ -2104,15 +2385,20 @@ ReadMapState _readMap(const QByteArray &pass) {
 		_mapChanged = false;
 	}
 
-	if (_locationsKey) {
-		_readLocations();
-	}
+	_locationsReadPending = (_locationsKey != 0);
 	if (_reportSpamStatusesKey) {
+		StartupTrace::Span trace("Local::readReportSpamStatuses");
 		_readReportSpamStatuses();
 	}
 
-	_readUserSettings();
-	_readMtpData();
+	{
+		StartupTrace::Span trace("Local::readUserSettings");
+		_readUserSettings();
+	}
+	{
+		StartupTrace::Span trace("Local::readMtpData");
+		_readMtpData();
+	}
 
 	Messenger::Instance().setAuthSessionFromStorage(std::move(StoredAuthSessionCache));
 
@@ -2137,6 +2423,8 @@ void _writeMap(WriteMapWhen when) {
 
 	if (!QDir().exists(_userBasePath)) QDir().mkpath(_userBasePath);
 
+	_ensureStorageMaps();
+
 	FileWriteDescriptor map(qsl("map"));
 	if (_passKeySalt.isEmpty() || _passKeyEncrypted.isEmpty()) {
 		QByteArray pass(kLocalKeySize, Qt::Uninitialized), salt(LocalEncryptSaltSize, Qt::Uninitialized);
@@ -2174,6 +2462,7 @@ void _writeMap(WriteMapWhen when) {
 	if (_backgroundKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_userSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentHashtagsAndBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_voiceWaveformsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	EncryptedDescriptor mapData(mapSize);
 	if (!_draftsMap.isEmpty()) {
 		mapData.stream << quint32(lskDraft) << quint32(_draftsMap.size());
@@ -2239,6 +2528,9 @@ void _writeMap(WriteMapWhen when) {
 	if (_recentHashtagsAndBotsKey) {
 		mapData.stream << quint32(lskRecentHashtagsAndBots) << quint64(_recentHashtagsAndBotsKey);
 	}
+	if (_voiceWaveformsKey) {
+		mapData.stream << quint32(lskVoiceWaveforms) << quint64(_voiceWaveformsKey);
+	}
 	map.writeEncrypted(mapData);
 
 	_mapChanged = false;
@@ -2403,6 +2695,8 @@ void reset() {
 	}
 
 	_passKeySalt.clear(); // reset passcode, local key
+	_storageMapsLoading = nullptr;
+	_locationsReadPending = false;
 	_draftsMap.clear();
 	_draftCursorsMap.clear();
 	_fileLocations.clear();
@@ -2420,6 +2714,12 @@ void reset() {
 	_installedStickersKey = _featuredStickersKey = _recentStickersKey = _favedStickersKey = _archivedStickersKey = 0;
 	_savedGifsKey = 0;
 	_backgroundKey = _userSettingsKey = _recentHashtagsAndBotsKey = _savedPeersKey = 0;
+	_voiceWaveformsKey = 0;
+	_voiceWaveforms.clear();
+	_voiceWaveformsOrder.clear();
+	_voiceWaveformsRead = false;
+	_waveformRequests.clear();
+	_waveformsCounting.clear();
 	_oldMapVersion = _oldSettingsVersion = 0;
 	StoredAuthSessionCache.reset();
 	_mapChanged = true;
@@ -2646,6 +2946,8 @@ bool hasDraft(const PeerId &peer) {
 void writeFileLocation(MediaKey location, const FileLocation &local) {
 	if (local.fname.isEmpty()) return;
 
+	_ensureLocationsRead();
+
 	FileLocationAliases::const_iterator aliasIt = _fileLocationAliases.constFind(location);
 	if (aliasIt != _fileLocationAliases.cend()) {
 		location = aliasIt.value();
@@ -2676,6 +2978,7 @@ void writeFileLocation(MediaKey location, const FileLocation &local) {
 }
 
 FileLocation readFileLocation(MediaKey location, bool check) {
+	_ensureLocationsRead();
 	FileLocationAliases::const_iterator aliasIt = _fileLocationAliases.constFind(location);
 	if (aliasIt != _fileLocationAliases.cend()) {
 		location = aliasIt.value();
@@ -2722,6 +3025,8 @@ qint32 _storageAudioSize(qint32 rawlen) {
 
 void writeImage(const StorageKey &location, const ImagePtr &image) {
 	if (image->isNull() || !image->loaded()) return;
+
+	_ensureStorageMaps();
 	if (_imagesMap.constFind(location) != _imagesMap.cend()) return;
 
 	image->forget();
@@ -2731,6 +3036,8 @@ void writeImage(const StorageKey &location, const ImagePtr &image) {
 void writeImage(const StorageKey &location, const StorageImageSaved &image, bool overwrite) {
 	if (!_working()) return;
 
+	_ensureStorageMaps();
+
 	qint32 size = _storageImageSize(image.data.size());
 	StorageMap::const_iterator i = _imagesMap.constFind(location);
 	if (i == _imagesMap.cend()) {
@@ -2748,7 +3055,7 @@ void writeImage(const StorageKey &location, const StorageImageSaved &image, bool
 	data.stream << quint64(location.first) << quint64(location.second) << quint32(legacyTypeField) << image.data;
 
 	FileWriteDescriptor file(i.value().first, FileOption::User);
-	file.writeEncrypted(data);
+	file.writeEncryptedChunked(data);
 	if (i.value().second != size) {
 		_storageImagesSize += size;
 		_storageImagesSize -= i.value().second;
@@ -2838,6 +3145,7 @@ public:
 };
 
 TaskId startImageLoad(const StorageKey &location, mtpFileLoader *loader) {
+	_ensureStorageMaps();
 	StorageMap::const_iterator j = _imagesMap.constFind(location);
 	if (j == _imagesMap.cend() || !_localLoader) {
 		return 0;
@@ -2847,16 +3155,20 @@ TaskId startImageLoad(const StorageKey &location, mtpFileLoader *loader) {
 }
 
 int32 hasImages() {
+	_ensureStorageMaps();
 	return _imagesMap.size();
 }
 
 qint64 storageImagesSize() {
+	_ensureStorageMaps();
 	return _storageImagesSize;
 }
 
 void writeStickerImage(const StorageKey &location, const QByteArray &sticker, bool overwrite) {
 	if (!_working()) return;
 
+	_ensureStorageMaps();
+
 	qint32 size = _storageStickerSize(sticker.size());
 	StorageMap::const_iterator i = _stickerImagesMap.constFind(location);
 	if (i == _stickerImagesMap.cend()) {
@@ -2870,7 +3182,7 @@ void writeStickerImage(const StorageKey &location, const QByteArray &sticker, bo
 	EncryptedDescriptor data(sizeof(quint64) * 2 + sizeof(quint32) + sizeof(quint32) + sticker.size());
 	data.stream << quint64(location.first) << quint64(location.second) << sticker;
 	FileWriteDescriptor file(i.value().first, FileOption::User);
-	file.writeEncrypted(data);
+	file.writeEncryptedChunked(data);
 	if (i.value().second != size) {
 		_storageStickersSize += size;
 		_storageStickersSize -= i.value().second;
@@ -2897,6 +3209,7 @@ public:
 };
 
 TaskId startStickerImageLoad(const StorageKey &location, mtpFileLoader *loader) {
+	_ensureStorageMaps();
 	auto j = _stickerImagesMap.constFind(location);
 	if (j == _stickerImagesMap.cend() || !_localLoader) {
 		return 0;
@@ -2906,10 +3219,12 @@ TaskId startStickerImageLoad(const StorageKey &location, mtpFileLoader *loader)
 }
 
 bool willStickerImageLoad(const StorageKey &location) {
+	_ensureStorageMaps();
 	return _stickerImagesMap.constFind(location) != _stickerImagesMap.cend();
 }
 
 bool copyStickerImage(const StorageKey &oldLocation, const StorageKey &newLocation) {
+	_ensureStorageMaps();
 	auto i = _stickerImagesMap.constFind(oldLocation);
 	if (i == _stickerImagesMap.cend()) {
 		return false;
@@ -2921,16 +3236,20 @@ bool copyStickerImage(const StorageKey &oldLocation, const StorageKey &newLocati
 }
 
 int32 hasStickers() {
+	_ensureStorageMaps();
 	return _stickerImagesMap.size();
 }
 
 qint64 storageStickersSize() {
+	_ensureStorageMaps();
 	return _storageStickersSize;
 }
 
 void writeAudio(const StorageKey &location, const QByteArray &audio, bool overwrite) {
 	if (!_working()) return;
 
+	_ensureStorageMaps();
+
 	qint32 size = _storageAudioSize(audio.size());
 	StorageMap::const_iterator i = _audiosMap.constFind(location);
 	if (i == _audiosMap.cend()) {
@@ -2944,7 +3263,7 @@ void writeAudio(const StorageKey &location, const QByteArray &audio, bool overwr
 	EncryptedDescriptor data(sizeof(quint64) * 2 + sizeof(quint32) + sizeof(quint32) + audio.size());
 	data.stream << quint64(location.first) << quint64(location.second) << audio;
 	FileWriteDescriptor file(i.value().first, FileOption::User);
-	file.writeEncrypted(data);
+	file.writeEncryptedChunked(data);
 	if (i.value().second != size) {
 		_storageAudiosSize += size;
 		_storageAudiosSize -= i.value().second;
@@ -2971,6 +3290,7 @@ public:
 };
 
 TaskId startAudioLoad(const StorageKey &location, mtpFileLoader *loader) {
+	_ensureStorageMaps();
 	auto j = _audiosMap.constFind(location);
 	if (j == _audiosMap.cend() || !_localLoader) {
 		return 0;
@@ -2980,6 +3300,7 @@ TaskId startAudioLoad(const StorageKey &location, mtpFileLoader *loader) {
 }
 
 bool copyAudio(const StorageKey &oldLocation, const StorageKey &newLocation) {
+	_ensureStorageMaps();
 	auto i = _audiosMap.constFind(oldLocation);
 	if (i == _audiosMap.cend()) {
 		return false;
@@ -2991,10 +3312,12 @@ bool copyAudio(const StorageKey &oldLocation, const StorageKey &newLocation) {
 }
 
 int32 hasAudios() {
+	_ensureStorageMaps();
 	return _audiosMap.size();
 }
 
 qint64 storageAudiosSize() {
+	_ensureStorageMaps();
 	return _storageAudiosSize;
 }
 
@@ -3009,6 +3332,8 @@ qint32 _storageWebFileSize(const QString &url, qint32 rawlen) {
 void writeWebFile(const QString &url, const QByteArray &content, bool overwrite) {
 	if (!_working()) return;
 
+	_ensureLocationsRead();
+
 	qint32 size = _storageWebFileSize(url, content.size());
 	WebFilesMap::const_iterator i = _webFilesMap.constFind(url);
 	if (i == _webFilesMap.cend()) {
@@ -3021,7 +3346,7 @@ void writeWebFile(const QString &url, const QByteArray &content, bool overwrite)
 	EncryptedDescriptor data(Serialize::stringSize(url) + sizeof(quint32) + sizeof(quint32) + content.size());
 	data.stream << url << content;
 	FileWriteDescriptor file(i.value().first, FileOption::User);
-	file.writeEncrypted(data);
+	file.writeEncryptedChunked(data);
 	if (i.value().second != size) {
 		_storageWebFilesSize += size;
 		_storageWebFilesSize -= i.value().second;
@@ -3088,6 +3413,7 @@ protected:
 };
 
 TaskId startWebFileLoad(const QString &url, webFileLoader *loader) {
+	_ensureLocationsRead();
 	WebFilesMap::const_iterator j = _webFilesMap.constFind(url);
 	if (j == _webFilesMap.cend() || !_localLoader) {
 		return 0;
@@ -3097,85 +3423,208 @@ TaskId startWebFileLoad(const QString &url, webFileLoader *loader) {
 }
 
 int32 hasWebFiles() {
+	_ensureLocationsRead();
 	return _webFilesMap.size();
 }
 
 qint64 storageWebFilesSize() {
+	_ensureLocationsRead();
 	return _storageWebFilesSize;
 }
 
-class CountWaveformTask : public Task {
-public:
-	CountWaveformTask(DocumentData *doc)
-		: _doc(doc)
-		, _loc(doc->location(true))
-		, _data(doc->data())
-		, _wavemax(0) {
-		if (_data.isEmpty() && !_loc.accessEnable()) {
-			_doc = 0;
+namespace {
+
+void _applyVoiceWaveform(
+		not_null<DocumentData*> document,
+		VoiceWaveform &&waveform) {
+	const auto voice = document->voice();
+	if (!voice) {
+		return;
+	}
+	if (waveform.isEmpty()) {
+		voice->waveform.resize(1);
+		voice->waveform[0] = -2;
+		voice->wavemax = 0;
+	} else {
+		voice->wavemax = *ranges::max_element(waveform);
+		voice->waveform = std::move(waveform);
+	}
+	auto &items = App::documentItems();
+	auto i = items.constFind(document);
+	if (i != items.cend()) {
+		for_const (auto item, i.value()) {
+			Auth().data().requestItemRepaint(item);
 		}
 	}
-	void process() {
-		if (!_doc) return;
+}
 
-		_waveform = audioCountWaveform(_loc, _data);
-		uchar wavemax = 0;
-		for (int32 i = 0, l = _waveform.size(); i < l; ++i) {
-			uchar waveat = _waveform.at(i);
-			if (wavemax < waveat) wavemax = waveat;
-		}
-		_wavemax = wavemax;
+void _readVoiceWaveforms() {
+	if (_voiceWaveformsRead) return;
+	_voiceWaveformsRead = true;
+	if (!_voiceWaveformsKey) return;
+
+	FileReadDescriptor waveforms;
+	if (!readEncryptedFile(waveforms, _voiceWaveformsKey)) {
+		clearKey(_voiceWaveformsKey);
+		_voiceWaveformsKey = 0;
+		_writeMap();
+		return;
 	}
-	void finish() {
-		if (const auto voice = _doc ? _doc->voice() : nullptr) {
-			if (!_waveform.isEmpty()) {
-				voice->waveform = _waveform;
-				voice->wavemax = _wavemax;
-			}
-			if (voice->waveform.isEmpty()) {
-				voice->waveform.resize(1);
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			} else if (voice->waveform[0] < 0) {
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			}
-			auto &items = App::documentItems();
-			auto i = items.constFind(_doc);
-			if (i != items.cend()) {
-				for_const (auto item, i.value()) {
-					Auth().data().requestItemRepaint(item);
-				}
-			}
+
+	qint32 count = 0;
+	waveforms.stream >> count;
+	for (auto i = 0; i < count; ++i) {
+		quint64 documentId = 0;
+		QByteArray encoded;
+		waveforms.stream >> documentId >> encoded;
+		if (!_checkStreamStatus(waveforms.stream)) {
+			_voiceWaveforms.clear();
+			_voiceWaveformsOrder.clear();
+			return;
+		}
+		if (!_voiceWaveforms.contains(documentId)) {
+			_voiceWaveforms.insert(documentId, encoded);
+			_voiceWaveformsOrder.push_back(documentId);
 		}
 	}
-	virtual ~CountWaveformTask() {
-		if (_data.isEmpty() && _doc) {
-			_loc.accessDisable();
+}
+
+void _writeVoiceWaveforms(WriteMapWhen when) {
+	if (!_working()) return;
+
+	if (when != WriteMapWhen::Now) {
+		_manager->writeVoiceWaveforms(when == WriteMapWhen::Fast);
+		return;
+	}
+	_manager->writingVoiceWaveforms();
+	if (_voiceWaveforms.isEmpty()) {
+		if (_voiceWaveformsKey) {
+			clearKey(_voiceWaveformsKey);
+			_voiceWaveformsKey = 0;
+			_mapChanged = true;
+			_writeMap();
 		}
+		return;
+	}
+	if (!_voiceWaveformsKey) {
+		_voiceWaveformsKey = genKey();
+		_mapChanged = true;
+		_writeMap(WriteMapWhen::Fast);
+	}
+	quint32 size = sizeof(qint32);
+	for (const auto documentId : _voiceWaveformsOrder) {
+		size += sizeof(quint64)
+			+ Serialize::bytearraySize(_voiceWaveforms.value(documentId));
+	}
+	EncryptedDescriptor data(size);
+	data.stream << qint32(_voiceWaveformsOrder.size());
+	for (const auto documentId : _voiceWaveformsOrder) {
+		data.stream
+			<< quint64(documentId)
+			<< _voiceWaveforms.value(documentId);
 	}
 
-protected:
-	DocumentData *_doc;
-	FileLocation _loc;
-	QByteArray _data;
-	VoiceWaveform _waveform;
-	char _wavemax;
+	FileWriteDescriptor file(_voiceWaveformsKey);
+	file.writeEncrypted(data);
+}
 
-};
+void _rememberVoiceWaveform(
+		DocumentId documentId,
+		const VoiceWaveform &waveform) {
+	_readVoiceWaveforms();
+	if (_voiceWaveforms.contains(documentId)) {
+		return;
+	}
+	_voiceWaveforms.insert(
+		documentId,
+		documentWaveformEncode5bit(waveform));
+	_voiceWaveformsOrder.push_back(documentId);
+	while (_voiceWaveformsOrder.size() > kVoiceWaveformsLimit) {
+		_voiceWaveforms.remove(_voiceWaveformsOrder.front());
+		_voiceWaveformsOrder.pop_front();
+	}
+	_writeVoiceWaveforms(WriteMapWhen::Soon);
+}
 
-void countVoiceWaveform(DocumentData *document) {
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(document));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+VoiceWaveform _cachedVoiceWaveform(DocumentId documentId) {
+	_readVoiceWaveforms();
+	const auto i = _voiceWaveforms.constFind(documentId);
+	return (i != _voiceWaveforms.cend())
+		? documentWaveformDecode(i.value())
+		: VoiceWaveform();
+}
+
+void _countVoiceWaveforms() {
+	while (_waveformWorkers < kWaveformWorkersCount
+		&& !_waveformRequests.empty()) {
+		const auto request = _waveformRequests.back();
+		_waveformRequests.pop_back();
+
+		const auto document = request.document;
+		auto location = document->location(true);
+		auto data = document->data();
+		if (data.isEmpty() && !location.accessEnable()) {
+			_applyVoiceWaveform(document, VoiceWaveform());
+			continue;
 		}
+		_waveformsCounting.emplace(request.id, document);
+		++_waveformWorkers;
+
+		crl::async([=] {
+			auto waveform = audioCountWaveform(location, data);
+			crl::on_main([=, waveform = std::move(waveform)]() mutable {
+				if (data.isEmpty()) {
+					location.accessDisable();
+				}
+				--_waveformWorkers;
+				const auto i = _waveformsCounting.find(request.id);
+				if (i != end(_waveformsCounting)) {
+					const auto document = i->second;
+					_waveformsCounting.erase(i);
+					if (!waveform.isEmpty()) {
+						_rememberVoiceWaveform(document->id, waveform);
+					}
+					_applyVoiceWaveform(document, std::move(waveform));
+				}
+				_countVoiceWaveforms();
+			});
+		});
 	}
 }
 
+} // namespace
+
+void countVoiceWaveform(DocumentData *document) {
+	const auto voice = document->voice();
+	if (!voice) {
+		return;
+	}
+	if (auto cached = _cachedVoiceWaveform(document->id); !cached.isEmpty()) {
+		_applyVoiceWaveform(document, std::move(cached));
+		return;
+	}
+
+	// Requests come from painting, so the latest ones are for the messages
+	// that are visible right now, they are counted first.
+	const auto taskId = ++_waveformLastId;
+	voice->waveform.resize(1 + sizeof(TaskId));
+	voice->waveform[0] = -1; // counting
+	memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+	_waveformRequests.push_back({ taskId, document });
+	_countVoiceWaveforms();
+}
+
+void cancelVoiceWaveform(TaskId id) {
+	const auto i = ranges::find(
+		_waveformRequests,
+		id,
+		[](const WaveformRequest &request) { return request.id; });
+	if (i != end(_waveformRequests)) {
+		_waveformRequests.erase(i);
+	}
+	_waveformsCounting.remove(id);
+}
+
 void cancelTask(TaskId id) {
 	if (_localLoader) {
 		_localLoader->cancelTask(id);
@@ -4438,6 +4887,9 @@ bool ClearManager::addTask(int task) {
 	QMutexLocker lock(&data->mutex);
 	if (!data->working) return false;
 
+	_ensureStorageMaps();
+	_ensureLocationsRead();
+
 	if (!data->tasks.isEmpty() && (data->tasks.at(0) == ClearManagerAll)) return true;
 	if (task == ClearManagerAll) {
 		data->tasks.clear();
@@ -4488,6 +4940,12 @@ bool ClearManager::addTask(int task) {
 			_recentHashtagsAndBotsKey = 0;
 			_mapChanged = true;
 		}
+		if (_voiceWaveformsKey) {
+			_voiceWaveformsKey = 0;
+			_voiceWaveforms.clear();
+			_voiceWaveformsOrder.clear();
+			_mapChanged = true;
+		}
 		if (_savedPeersKey) {
 			_savedPeersKey = 0;
 			_mapChanged = true;
@@ -4680,6 +5138,8 @@ Manager::Manager() {
 	connect(&_mapWriteTimer, SIGNAL(timeout()), this, SLOT(mapWriteTimeout()));
 	_locationsWriteTimer.setSingleShot(true);
 	connect(&_locationsWriteTimer, SIGNAL(timeout()), this, SLOT(locationsWriteTimeout()));
+	_voiceWaveformsWriteTimer.setSingleShot(true);
+	connect(&_voiceWaveformsWriteTimer, SIGNAL(timeout()), this, SLOT(voiceWaveformsWriteTimeout()));
 }
 
 void Manager::writeMap(bool fast) {
@@ -4706,6 +5166,18 @@ void Manager::writingLocations() {
 	_locationsWriteTimer.stop();
 }
 
+void Manager::writeVoiceWaveforms(bool fast) {
+	if (!_voiceWaveformsWriteTimer.isActive() || fast) {
+		_voiceWaveformsWriteTimer.start(fast ? 1 : WriteMapTimeout);
+	} else if (_voiceWaveformsWriteTimer.remainingTime() <= 0) {
+		voiceWaveformsWriteTimeout();
+	}
+}
+
+void Manager::writingVoiceWaveforms() {
+	_voiceWaveformsWriteTimer.stop();
+}
+
 void Manager::mapWriteTimeout() {
 	_writeMap(WriteMapWhen::Now);
 }
@@ -4714,6 +5186,10 @@ void Manager::locationsWriteTimeout() {
 	_writeLocations(WriteMapWhen::Now);
 }
 
+void Manager::voiceWaveformsWriteTimeout() {
+	_writeVoiceWaveforms(WriteMapWhen::Now);
+}
+
 void Manager::finish() {
 	if (_mapWriteTimer.isActive()) {
 		mapWriteTimeout();
@@ -4721,6 +5197,9 @@ void Manager::finish() {
 	if (_locationsWriteTimer.isActive()) {
 		locationsWriteTimeout();
 	}
+	if (_voiceWaveformsWriteTimer.isActive()) {
+		voiceWaveformsWriteTimeout();
+	}
 }
 
 } // namespace internal
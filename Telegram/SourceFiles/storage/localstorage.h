@@ -117,6 +117,7 @@ int32 hasWebFiles();
 qint64 storageWebFilesSize();
 
 void countVoiceWaveform(DocumentData *document);
+void cancelVoiceWaveform(TaskId id);
 
 void cancelTask(TaskId id);
 
@@ -178,15 +179,19 @@ public:
 	void writingMap();
 	void writeLocations(bool fast);
 	void writingLocations();
+	void writeVoiceWaveforms(bool fast);
+	void writingVoiceWaveforms();
 	void finish();
 
 public slots:
 	void mapWriteTimeout();
 	void locationsWriteTimeout();
+	void voiceWaveformsWriteTimeout();
 
 private:
 	QTimer _mapWriteTimer;
 	QTimer _locationsWriteTimer;
+	QTimer _voiceWaveformsWriteTimer;
 
 };
 
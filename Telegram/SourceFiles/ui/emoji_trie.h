@@ -0,0 +1,55 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtCore/QChar>
+#include <algorithm>
+
+namespace Ui {
+namespace Emoji {
+
+// Longest match lookup in the tries written by codegen_emoji, the nodes
+// are laid out breadth-first with the children sorted by code unit.
+// The generated code and the generator checking its tables both use it.
+template <typename Node>
+int FindInTrie(
+		const Node *trie,
+		const QChar *start,
+		const QChar *end,
+		int *outLength,
+		bool skipPostfixes) {
+	constexpr auto kSkippedPostfix = ushort(0xFE0FU);
+
+	auto result = 0;
+	auto node = trie;
+	for (auto ch = start; ch != end && node->childrenCount;) {
+		const auto code = ch->unicode();
+		const auto from = trie + node->childrenStart;
+		const auto till = from + node->childrenCount;
+		const auto child = std::lower_bound(from, till, code, [](const Node &node, ushort code) {
+			return (node.ch < code);
+		});
+		if (child == till || child->ch != code) {
+			break;
+		}
+		if (++ch != end
+			&& skipPostfixes
+			&& ch->unicode() == kSkippedPostfix) {
+			++ch;
+		}
+		if (child->value) {
+			result = child->value;
+			if (outLength) *outLength = (ch - start);
+		}
+		node = child;
+	}
+	return result;
+}
+
+} // namespace Emoji
+} // namespace Ui
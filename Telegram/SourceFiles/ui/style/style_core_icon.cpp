@@ -11,15 +11,92 @@ namespace style {
 namespace internal {
 namespace {
 
+constexpr auto kAtlasSheetSize = 512;
+constexpr auto kAtlasPadding = 1;
+
 uint32 colorKey(QColor c) {
 	return (((((uint32(c.red()) << 8) | uint32(c.green())) << 8) | uint32(c.blue())) << 8) | uint32(c.alpha());
 }
 
+// Colorized icons of the current palette packed in a few large images,
+// so that a palette change drops several sheets instead of an image per
+// icon and the first paint of an icon doesn't allocate an image for it.
+class IconAtlas {
+public:
+	struct Place {
+		const QImage *image = nullptr;
+		QRect rect;
+	};
+
+	Place add(const QImage &mask, QColor color);
+
+private:
+	struct Sheet {
+		QImage image;
+		int shelfLeft = 0;
+		int shelfTop = 0;
+		int shelfHeight = 0;
+	};
+
+	not_null<Sheet*> createSheet(QSize size);
+	Sheet *packingSheet(QSize size);
+
+	// Sheets are never moved, icons keep pointers to their images.
+	std::vector<std::unique_ptr<Sheet>> _sheets;
+	Sheet *_packing = nullptr;
+
+};
+
+IconAtlas::Place IconAtlas::add(const QImage &mask, QColor color) {
+	const auto size = mask.size();
+	QImage *image = nullptr;
+	auto rect = QRect(QPoint(), size);
+	if (const auto sheet = packingSheet(size)) {
+		rect.moveTo(sheet->shelfLeft, sheet->shelfTop);
+		sheet->shelfLeft += size.width() + kAtlasPadding;
+		accumulate_max(sheet->shelfHeight, size.height() + kAtlasPadding);
+		image = &sheet->image;
+	} else {
+		// Large icons get a separate sheet each.
+		image = &createSheet(size)->image;
+	}
+	colorizeImage(mask, color, image, mask.rect(), rect.topLeft());
+
+	auto result = Place();
+	result.image = image;
+	result.rect = rect;
+	return result;
+}
+
+not_null<IconAtlas::Sheet*> IconAtlas::createSheet(QSize size) {
+	_sheets.push_back(std::make_unique<Sheet>());
+	const auto result = _sheets.back().get();
+	result->image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+	result->image.fill(Qt::transparent);
+	return result;
+}
+
+IconAtlas::Sheet *IconAtlas::packingSheet(QSize size) {
+	const auto sheetSize = kAtlasSheetSize * cIntRetinaFactor();
+	if (size.width() > sheetSize / 4 || size.height() > sheetSize / 4) {
+		return nullptr;
+	}
+	if (_packing && _packing->shelfLeft + size.width() > sheetSize) {
+		_packing->shelfLeft = 0;
+		_packing->shelfTop += base::take(_packing->shelfHeight);
+	}
+	if (!_packing || _packing->shelfTop + size.height() > sheetSize) {
+		_packing = createSheet(QSize(sheetSize, sheetSize));
+	}
+	return _packing;
+}
+
 using IconMasks = QMap<const IconMask*, QImage>;
-using IconPixmaps = QMap<QPair<const IconMask*, uint32>, QPixmap>;
+using IconPlaces = QMap<QPair<const IconMask*, uint32>, IconAtlas::Place>;
 using IconDatas = OrderedSet<IconData*>;
 NeverFreedPointer<IconMasks> iconMasks;
-NeverFreedPointer<IconPixmaps> iconPixmaps;
+NeverFreedPointer<IconAtlas> iconAtlas;
+NeverFreedPointer<IconPlaces> iconPlaces;
 NeverFreedPointer<IconDatas> iconData;
 
 inline int pxAdjust(int value, int scale) {
@@ -100,7 +177,9 @@ MonoIcon::MonoIcon(const IconMask *mask, Color color, QPoint offset)
 }
 
 void MonoIcon::reset() const {
-	_pixmap = QPixmap();
+	_atlasImage = nullptr;
+	_atlasRect = QRect();
+	_fillImage = QImage();
 	_size = QSize();
 }
 
@@ -130,19 +209,24 @@ void MonoIcon::paint(QPainter &p, const QPoint &pos, int outerw) const {
 	int partPosY = fullOffset.y();
 
 	ensureLoaded();
-	if (_pixmap.isNull()) {
+	if (!_atlasImage) {
 		p.fillRect(partPosX, partPosY, w, h, _color);
 	} else {
-		p.drawPixmap(partPosX, partPosY, _pixmap);
+		p.drawImage(QPoint(partPosX, partPosY), *_atlasImage, _atlasRect);
 	}
 }
 
 void MonoIcon::fill(QPainter &p, const QRect &rect) const {
 	ensureLoaded();
-	if (_pixmap.isNull()) {
+	if (!_atlasImage) {
 		p.fillRect(rect, _color);
 	} else {
-		p.drawPixmap(rect, _pixmap, QRect(0, 0, _pixmap.width(), _pixmap.height()));
+		// Stretching a part of the sheet could blend in the neighbours.
+		if (_fillImage.isNull()) {
+			_fillImage = _atlasImage->copy(_atlasRect);
+			_fillImage.setDevicePixelRatio(cRetinaFactor());
+		}
+		p.drawImage(rect, _fillImage, _fillImage.rect());
 	}
 }
 
@@ -153,7 +237,7 @@ void MonoIcon::paint(QPainter &p, const QPoint &pos, int outerw, QColor colorOve
 	int partPosY = fullOffset.y();
 
 	ensureLoaded();
-	if (_pixmap.isNull()) {
+	if (!_atlasImage) {
 		p.fillRect(partPosX, partPosY, w, h, colorOverride);
 	} else {
 		ensureColorizedImage(colorOverride);
@@ -163,7 +247,7 @@ void MonoIcon::paint(QPainter &p, const QPoint &pos, int outerw, QColor colorOve
 
 void MonoIcon::fill(QPainter &p, const QRect &rect, QColor colorOverride) const {
 	ensureLoaded();
-	if (_pixmap.isNull()) {
+	if (!_atlasImage) {
 		p.fillRect(rect, colorOverride);
 	} else {
 		ensureColorizedImage(colorOverride);
@@ -226,7 +310,7 @@ QImage MonoIcon::instance(QColor colorOverride, DBIScale scale) const {
 		ensureLoaded();
 		auto result = QImage(size() * cIntRetinaFactor(), QImage::Format_ARGB32_Premultiplied);
 		result.setDevicePixelRatio(cRetinaFactor());
-		if (_pixmap.isNull()) {
+		if (!_atlasImage) {
 			result.fill(colorOverride);
 		} else {
 			colorizeImage(_maskImage, colorOverride, &result);
@@ -252,7 +336,7 @@ void MonoIcon::ensureLoaded() const {
 		return;
 	}
 	if (!_maskImage.isNull()) {
-		createCachedPixmap();
+		createCachedImage();
 		return;
 	}
 
@@ -265,7 +349,7 @@ void MonoIcon::ensureLoaded() const {
 		}
 		_maskImage = i.value();
 
-		createCachedPixmap();
+		createCachedImage();
 	}
 }
 
@@ -274,16 +358,17 @@ void MonoIcon::ensureColorizedImage(QColor color) const {
 	colorizeImage(_maskImage, color, &_colorizedImage);
 }
 
-void MonoIcon::createCachedPixmap() const {
-	iconPixmaps.createIfNull();
+void MonoIcon::createCachedImage() const {
+	iconAtlas.createIfNull();
+	iconPlaces.createIfNull();
 	auto key = qMakePair(_mask, colorKey(_color->c));
-	auto j = iconPixmaps->constFind(key);
-	if (j == iconPixmaps->cend()) {
-		auto image = colorizeImage(_maskImage, _color);
-		j = iconPixmaps->insert(key, App::pixmapFromImageInPlace(std::move(image)));
+	auto j = iconPlaces->constFind(key);
+	if (j == iconPlaces->cend()) {
+		j = iconPlaces->insert(key, iconAtlas->add(_maskImage, _color->c));
 	}
-	_pixmap = j.value();
-	_size = _pixmap.size() / cIntRetinaFactor();
+	_atlasImage = j.value().image;
+	_atlasRect = j.value().rect;
+	_size = _atlasRect.size() / cIntRetinaFactor();
 }
 
 void IconData::created() {
@@ -341,7 +426,8 @@ int IconData::height() const {
 }
 
 void resetIcons() {
-	iconPixmaps.clear();
+	iconPlaces.clear();
+	iconAtlas.clear();
 	if (iconData) {
 		for (auto data : *iconData) {
 			data->reset();
@@ -351,7 +437,8 @@ void resetIcons() {
 
 void destroyIcons() {
 	iconData.clear();
-	iconPixmaps.clear();
+	iconPlaces.clear();
+	iconAtlas.clear();
 	iconMasks.clear();
 }
 
@@ -65,14 +65,16 @@ public:
 
 private:
 	void ensureLoaded() const;
-	void createCachedPixmap() const;
+	void createCachedImage() const;
 	void ensureColorizedImage(QColor color) const;
 
 	const IconMask *_mask = nullptr;
 	Color _color;
 	QPoint _offset = { 0, 0 };
 	mutable QImage _maskImage, _colorizedImage;
-	mutable QPixmap _pixmap; // for pixmaps
+	mutable const QImage *_atlasImage = nullptr; // for masks
+	mutable QRect _atlasRect;
+	mutable QImage _fillImage;
 	mutable QSize _size; // for rects
 
 };
@@ -2421,7 +2421,8 @@ Text::Text(const Text &other)
 , _text(other._text)
 , _st(other._st)
 , _links(other._links)
-, _startDir(other._startDir) {
+, _startDir(other._startDir)
+, _wordsUnloaded(other._wordsUnloaded) {
 	_blocks.reserve(other._blocks.size());
 	for (auto &block : other._blocks) {
 		_blocks.push_back(block->clone());
@@ -2436,7 +2437,8 @@ Text::Text(Text &&other)
 , _st(other._st)
 , _blocks(std::move(other._blocks))
 , _links(other._links)
-, _startDir(other._startDir) {
+, _startDir(other._startDir)
+, _wordsUnloaded(other._wordsUnloaded) {
 	other.clearFields();
 }
 
@@ -2449,6 +2451,7 @@ Text &Text::operator=(const Text &other) {
 	_blocks = TextBlocks(other._blocks.size());
 	_links = other._links;
 	_startDir = other._startDir;
+	_wordsUnloaded = other._wordsUnloaded;
 	for (int32 i = 0, l = _blocks.size(); i < l; ++i) {
 		_blocks[i] = other._blocks.at(i)->clone();
 	}
@@ -2464,6 +2467,7 @@ Text &Text::operator=(Text &&other) {
 	_blocks = std::move(other._blocks);
 	_links = other._links;
 	_startDir = other._startDir;
+	_wordsUnloaded = other._wordsUnloaded;
 	other.clearFields();
 	return *this;
 }
@@ -2696,6 +2700,34 @@ void Text::removeSkipBlock() {
 	}
 }
 
+void Text::unloadWords() {
+	if (!_wordsUnloaded) {
+		unloadWordsInBlocks();
+	}
+}
+
+void Text::loadWords() const {
+	if (!_wordsUnloaded) {
+		return;
+	}
+	for (auto i = _blocks.cbegin(), e = _blocks.cend(); i != e; ++i) {
+		if ((*i)->type() == TextBlockTText) {
+			const auto block = static_cast<TextBlock*>(i->get());
+			block->loadWords(_st->font, _text, _minResizeWidth, countBlockLength(i, e));
+		}
+	}
+	_wordsUnloaded = false;
+}
+
+void Text::unloadWordsInBlocks() const {
+	for (const auto &block : _blocks) {
+		if (block->type() == TextBlockTText) {
+			static_cast<TextBlock*>(block.get())->unloadWords();
+		}
+	}
+	_wordsUnloaded = true;
+}
+
 int Text::countWidth(int width) const {
 	if (QFixed(width) >= _maxWidth) {
 		return _maxWidth.ceil().toInt();
@@ -2732,6 +2764,10 @@ void Text::enumerateLines(int w, Callback callback) const {
 	QFixed width = w;
 	if (width < _minResizeWidth) width = _minResizeWidth;
 
+	// The words are kept after measuring, so that each resize step
+	// doesn't shape the whole text again.
+	loadWords();
+
 	int lineHeight = 0;
 	QFixed widthLeft = width, last_rBearing = 0, last_rPadding = 0;
 	bool longWordLine = true;
@@ -2839,22 +2875,26 @@ void Text::enumerateLines(int w, Callback callback) const {
 
 void Text::draw(Painter &painter, int32 left, int32 top, int32 w, style::align align, int32 yFrom, int32 yTo, TextSelection selection, bool fullWidthSelection) const {
 //	painter.fillRect(QRect(left, top, w, countHeight(w)), QColor(0, 0, 0, 32)); // debug
+	loadWords();
 	TextPainter p(&painter, this);
 	p.draw(left, top, w, align, yFrom, yTo, selection, fullWidthSelection);
 }
 
 void Text::drawElided(Painter &painter, int32 left, int32 top, int32 w, int32 lines, style::align align, int32 yFrom, int32 yTo, int32 removeFromEnd, bool breakEverywhere, TextSelection selection) const {
 //	painter.fillRect(QRect(left, top, w, countHeight(w)), QColor(0, 0, 0, 32)); // debug
+	loadWords();
 	TextPainter p(&painter, this);
 	p.drawElided(left, top, w, align, lines, yFrom, yTo, removeFromEnd, breakEverywhere, selection);
 }
 
 Text::StateResult Text::getState(QPoint point, int width, StateRequest request) const {
+	loadWords();
 	TextPainter p(0, this);
 	return p.getState(point, width, request);
 }
 
 Text::StateResult Text::getStateElided(QPoint point, int width, StateRequestElided request) const {
+	loadWords();
 	TextPainter p(0, this);
 	return p.getStateElided(point, width, request);
 }
@@ -3050,6 +3090,7 @@ void Text::clearFields() {
 	_links.clear();
 	_maxWidth = _minHeight = 0;
 	_startDir = Qt::LayoutDirectionAuto;
+	_wordsUnloaded = false;
 }
 
 Text::~Text() = default;
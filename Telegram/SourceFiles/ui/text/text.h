@@ -92,6 +92,13 @@ public:
 	void setSkipBlock(int32 width, int32 height);
 	void removeSkipBlock();
 
+	// Drops the word layout of the text blocks, it is built again by the
+	// next draw(), getState() or size counting call.
+	void unloadWords();
+	bool wordsUnloaded() const {
+		return _wordsUnloaded;
+	}
+
 	int32 maxWidth() const {
 		return _maxWidth.ceil().toInt();
 	}
@@ -209,6 +216,9 @@ private:
 
 	void recountNaturalSize(bool initial, Qt::LayoutDirection optionsDir = Qt::LayoutDirectionAuto);
 
+	void loadWords() const;
+	void unloadWordsInBlocks() const;
+
 	// clear() deletes all blocks and calls this method
 	// it is also called from move constructor / assignment operator
 	void clearFields();
@@ -224,6 +234,7 @@ private:
 	TextLinks _links;
 
 	Qt::LayoutDirection _startDir = Qt::LayoutDirectionAuto;
+	mutable bool _wordsUnloaded = false;
 
 	friend class TextParser;
 	friend class TextPainter;
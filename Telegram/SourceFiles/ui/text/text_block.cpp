@@ -141,6 +141,31 @@ static inline void addNextCluster(int &pos, int end, ScriptLine &line, int &glyp
 	++glyphCount;
 }
 
+style::font WithFlags(const style::font &font, int32 flags) {
+	auto result = font;
+	if ((flags & TextBlockFPre) || (flags & TextBlockFCode)) {
+		result = App::monofont();
+		if (result->size() != font->size() || result->flags() != font->flags()) {
+			result = style::font(font->size(), font->flags(), result->family());
+		}
+	} else {
+		if (flags & TextBlockFBold) {
+			result = result->bold();
+		} else if (flags & TextBlockFSemibold) {
+			result = st::semiboldFont;
+			if (result->size() != font->size() || result->flags() != font->flags()) {
+				result = style::font(font->size(), font->flags(), result->family());
+			}
+		}
+		if (flags & TextBlockFItalic) result = result->italic();
+		if (flags & TextBlockFUnderline) result = result->underline();
+		if (flags & TextBlockFTilde) { // tilde fix in OpenSans
+			result = st::semiboldFont;
+		}
+	}
+	return result;
+}
+
 } // anonymous namespace
 
 class BlockParser {
@@ -286,33 +311,20 @@ QFixed ITextBlock::f_rbearing() const {
 
 TextBlock::TextBlock(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex) : ITextBlock(font, str, from, length, flags, lnkIndex) {
 	_flags |= ((TextBlockTText & 0x0F) << 8);
-	if (length) {
-		style::font blockFont = font;
-		if (!flags && lnkIndex) {
-			// should use TextStyle lnkFlags somehow... not supported
-		}
+	loadWords(font, str, minResizeWidth, length);
+}
 
-		if ((flags & TextBlockFPre) || (flags & TextBlockFCode)) {
-			blockFont = App::monofont();
-			if (blockFont->size() != font->size() || blockFont->flags() != font->flags()) {
-				blockFont = style::font(font->size(), font->flags(), blockFont->family());
-			}
-		} else {
-			if (flags & TextBlockFBold) {
-				blockFont = blockFont->bold();
-			} else if (flags & TextBlockFSemibold) {
-				blockFont = st::semiboldFont;
-				if (blockFont->size() != font->size() || blockFont->flags() != font->flags()) {
-					blockFont = style::font(font->size(), font->flags(), blockFont->family());
-				}
-			}
-			if (flags & TextBlockFItalic) blockFont = blockFont->italic();
-			if (flags & TextBlockFUnderline) blockFont = blockFont->underline();
-			if (flags & TextBlockFTilde) { // tilde fix in OpenSans
-				blockFont = st::semiboldFont;
-			}
-		}
+void TextBlock::unloadWords() {
+	if (_words.size() > 1) {
+		_words.erase(_words.begin(), _words.end() - 1);
+		_words.squeeze();
+	}
+}
 
+void TextBlock::loadWords(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 length) {
+	_width = 0;
+	if (length) {
+		const auto blockFont = WithFlags(font, flags());
 		const auto part = str.mid(_from, length);
 
 		// Attempt to catch a crash in text processing
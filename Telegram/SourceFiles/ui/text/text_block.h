@@ -112,9 +112,9 @@ class TextWord {
 public:
 	TextWord() = default;
 	TextWord(uint16 from, QFixed width, QFixed rbearing, QFixed rpadding = 0)
-		: _from(from)
-		, _width(width)
+		: _width(width)
 		, _rpadding(rpadding)
+		, _from(from)
 		, _rbearing(rbearing.value() > 0x7FFF ? 0x7FFF : (rbearing.value() < -0x7FFF ? -0x7FFF : rbearing.value())) {
 	}
 	uint16 from() const {
@@ -134,8 +134,9 @@ public:
 	}
 
 private:
-	uint16 _from = 0;
+	// Both 16 bit fields go together to keep the word in 12 bytes.
 	QFixed _width, _rpadding;
+	uint16 _from = 0;
 	int16 _rbearing = 0;
 
 };
@@ -154,6 +155,10 @@ private:
 		return _words.isEmpty() ? 0 : _words.back().f_rbearing();
 	}
 
+	// Only the last word is kept, it holds the block right bearing.
+	void unloadWords();
+	void loadWords(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 length);
+
 	typedef QVector<TextWord> TextWords;
 	TextWords _words;
 
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "auth_session.h"
 #include "lang/lang_tag.h"
+#include "ui/text/text_entity_scanner.h"
 
 namespace TextUtilities {
 namespace {
@@ -1799,6 +1800,7 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 	int32 len = result.text.size(), commandOffset = rich ? 0 : len;
 	bool inLink = false, commandIsLink = false;
 	const QChar *start = result.text.constData(), *end = start + result.text.size();
+	auto scanner = EntityScanner(result.text);
 	for (int32 offset = 0, matchOffset = offset, mentionSkip = 0; offset < len;) {
 		if (commandOffset <= offset) {
 			for (commandOffset = offset; commandOffset < len; ++commandOffset) {
@@ -1809,45 +1811,31 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 				}
 			}
 		}
-		auto mDomain = RegExpDomain().match(result.text, matchOffset);
-		auto mExplicitDomain = RegExpDomainExplicit().match(result.text, matchOffset);
-		auto mHashtag = withHashtags ? RegExpHashtag().match(result.text, matchOffset) : QRegularExpressionMatch();
-		auto mMention = withMentions ? RegExpMention().match(result.text, qMax(mentionSkip, matchOffset)) : QRegularExpressionMatch();
-		auto mBotCommand = withBotCommands ? RegExpBotCommand().match(result.text, matchOffset) : QRegularExpressionMatch();
+		auto mDomain = scanner.domain(matchOffset);
+		auto mExplicitDomain = scanner.domainExplicit(matchOffset);
+		auto mHashtag = withHashtags ? scanner.hashtag(matchOffset) : TagMatch();
+		auto mMention = withMentions ? scanner.mention(qMax(mentionSkip, matchOffset)) : TagMatch();
+		auto mBotCommand = withBotCommands ? scanner.botCommand(matchOffset) : TagMatch();
 
 		EntityInTextType lnkType = EntityInTextUrl;
 		int32 lnkStart = 0, lnkLength = 0;
-		int32 domainStart = mDomain.hasMatch() ? mDomain.capturedStart() : INT_MAX,
-			domainEnd = mDomain.hasMatch() ? mDomain.capturedEnd() : INT_MAX,
-			explicitDomainStart = mExplicitDomain.hasMatch() ? mExplicitDomain.capturedStart() : INT_MAX,
-			explicitDomainEnd = mExplicitDomain.hasMatch() ? mExplicitDomain.capturedEnd() : INT_MAX,
-			hashtagStart = mHashtag.hasMatch() ? mHashtag.capturedStart() : INT_MAX,
-			hashtagEnd = mHashtag.hasMatch() ? mHashtag.capturedEnd() : INT_MAX,
-			mentionStart = mMention.hasMatch() ? mMention.capturedStart() : INT_MAX,
-			mentionEnd = mMention.hasMatch() ? mMention.capturedEnd() : INT_MAX,
-			botCommandStart = mBotCommand.hasMatch() ? mBotCommand.capturedStart() : INT_MAX,
-			botCommandEnd = mBotCommand.hasMatch() ? mBotCommand.capturedEnd() : INT_MAX;
-		if (mHashtag.hasMatch()) {
-			if (!mHashtag.capturedRef(1).isEmpty()) {
-				++hashtagStart;
-			}
-			if (!mHashtag.capturedRef(2).isEmpty()) {
-				--hashtagEnd;
-			}
-		}
-		while (mMention.hasMatch()) {
-			if (!mMention.capturedRef(1).isEmpty()) {
-				++mentionStart;
-			}
-			if (!mMention.capturedRef(2).isEmpty()) {
-				--mentionEnd;
-			}
+		int32 domainStart = mDomain.valid() ? mDomain.start : INT_MAX,
+			domainEnd = mDomain.valid() ? mDomain.end : INT_MAX,
+			explicitDomainStart = mExplicitDomain.valid() ? mExplicitDomain.start : INT_MAX,
+			explicitDomainEnd = mExplicitDomain.valid() ? mExplicitDomain.end : INT_MAX,
+			hashtagStart = mHashtag.valid() ? mHashtag.start : INT_MAX,
+			hashtagEnd = mHashtag.valid() ? mHashtag.end : INT_MAX,
+			mentionStart = mMention.valid() ? mMention.start : INT_MAX,
+			mentionEnd = mMention.valid() ? mMention.end : INT_MAX,
+			botCommandStart = mBotCommand.valid() ? mBotCommand.start : INT_MAX,
+			botCommandEnd = mBotCommand.valid() ? mBotCommand.end : INT_MAX;
+		while (mMention.valid()) {
 			if (!(start + mentionStart + 1)->isLetter() || !(start + mentionEnd - 1)->isLetterOrNumber()) {
 				mentionSkip = mentionEnd;
-				mMention = RegExpMention().match(result.text, qMax(mentionSkip, matchOffset));
-				if (mMention.hasMatch()) {
-					mentionStart = mMention.capturedStart();
-					mentionEnd = mMention.capturedEnd();
+				mMention = scanner.mention(qMax(mentionSkip, matchOffset));
+				if (mMention.valid()) {
+					mentionStart = mMention.start;
+					mentionEnd = mMention.end;
 				} else {
 					mentionStart = INT_MAX;
 					mentionEnd = INT_MAX;
@@ -1856,15 +1844,7 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 				break;
 			}
 		}
-		if (mBotCommand.hasMatch()) {
-			if (!mBotCommand.capturedRef(1).isEmpty()) {
-				++botCommandStart;
-			}
-			if (!mBotCommand.capturedRef(3).isEmpty()) {
-				--botCommandEnd;
-			}
-		}
-		if (!mDomain.hasMatch() && !mExplicitDomain.hasMatch() && !mHashtag.hasMatch() && !mMention.hasMatch() && !mBotCommand.hasMatch()) {
+		if (!mDomain.valid() && !mExplicitDomain.valid() && !mHashtag.valid() && !mMention.valid() && !mBotCommand.valid()) {
 			break;
 		}
 
@@ -1910,19 +1890,14 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 				continue;
 			}
 
-			auto protocol = mDomain.captured(1).toLower();
-			auto topDomain = mDomain.captured(3).toLower();
+			auto protocol = result.text.mid(mDomain.protocolStart, mDomain.protocolLength).toLower();
+			auto topDomain = result.text.mid(mDomain.topDomainStart, mDomain.topDomainLength).toLower();
 			auto isProtocolValid = protocol.isEmpty() || IsValidProtocol(protocol);
 			auto isTopDomainValid = !protocol.isEmpty() || IsValidTopDomain(topDomain);
 
 			if (protocol.isEmpty() && domainStart > offset + 1 && *(start + domainStart - 1) == QChar('@')) {
-				auto forMailName = result.text.mid(offset, domainStart - offset - 1);
-				auto mMailName = RegExpMailNameAtEnd().match(forMailName);
-				if (mMailName.hasMatch()) {
-					auto mailStart = offset + mMailName.capturedStart();
-					if (mailStart < offset) {
-						mailStart = offset;
-					}
+				auto mailStart = FindMailNameStart(result.text, offset, domainStart - 1);
+				if (mailStart >= 0) {
 					lnkType = EntityInTextEmail;
 					lnkStart = mailStart;
 					lnkLength = domainEnd - mailStart;
@@ -1936,7 +1911,7 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 				lnkStart = domainStart;
 
 				QStack<const QChar*> parenth;
-				const QChar *domainEnd = start + mDomain.capturedEnd(), *p = domainEnd;
+				const QChar *domainEnd = start + mDomain.end, *p = domainEnd;
 				for (; p < end; ++p) {
 					QChar ch(*p);
 					if (chIsLinkEnd(ch)) break; // link finished
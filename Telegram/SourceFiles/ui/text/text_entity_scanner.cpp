@@ -0,0 +1,435 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "ui/text/text_entity_scanner.h"
+
+namespace TextUtilities {
+namespace {
+
+constexpr auto kMaxDomainLabels = 10;
+constexpr auto kMinTopDomainLength = 2;
+constexpr auto kMaxTopDomainLength = 22;
+constexpr auto kMinHashtagLength = 2;
+constexpr auto kMaxHashtagLength = 64;
+constexpr auto kMaxMentionLength = 32;
+constexpr auto kMaxBotCommandLength = 64;
+constexpr auto kMinBotUsernameLength = 5;
+constexpr auto kMaxBotUsernameLength = 32;
+constexpr auto kMaxMailNameLength = 256;
+
+struct CodePoint {
+	uint code = 0;
+	int length = 0;
+};
+
+// Invalid surrogates are returned as is, they are not word characters.
+inline CodePoint ReadForward(const QChar *ch, const QChar *end) {
+	if (ch->isHighSurrogate() && ch + 1 < end && (ch + 1)->isLowSurrogate()) {
+		return { QChar::surrogateToUcs4(*ch, *(ch + 1)), 2 };
+	}
+	return { ch->unicode(), 1 };
+}
+
+inline CodePoint ReadBackward(const QChar *start, const QChar *ch) {
+	if ((ch - 1)->isLowSurrogate()
+		&& ch - 1 > start
+		&& (ch - 2)->isHighSurrogate()) {
+		return { QChar::surrogateToUcs4(*(ch - 2), *(ch - 1)), 2 };
+	}
+	return { (ch - 1)->unicode(), 1 };
+}
+
+// \w with QRegularExpression::UseUnicodePropertiesOption.
+inline bool IsWord(uint code) {
+	return (code == '_') || QChar::isLetterOrNumber(code);
+}
+
+// \d with QRegularExpression::UseUnicodePropertiesOption.
+inline bool IsDigit(uint code) {
+	return (QChar::category(code) == QChar::Number_DecimalDigit);
+}
+
+// \s with QRegularExpression::UseUnicodePropertiesOption.
+inline bool IsSpace(uint code) {
+	return (code != 0x85U) && QChar::isSpace(code);
+}
+
+inline bool IsAsciiLetter(ushort code) {
+	return (code >= 'a' && code <= 'z') || (code >= 'A' && code <= 'Z');
+}
+
+inline bool IsAsciiWord(ushort code) {
+	return IsAsciiLetter(code)
+		|| (code >= '0' && code <= '9')
+		|| (code == '_');
+}
+
+// [A-Za-zА-ЯЁа-яё0-9\-\_]
+inline bool IsDomainLabel(ushort code) {
+	return IsAsciiWord(code)
+		|| (code == '-')
+		|| (code >= 0x410U && code <= 0x44FU)
+		|| (code == 0x401U)
+		|| (code == 0x451U);
+}
+
+// [A-Za-zрф\-\d]
+inline bool IsTopDomain(uint code) {
+	return (code < 0x80U && IsAsciiLetter(ushort(code)))
+		|| (code == '-')
+		|| (code == 0x440U)
+		|| (code == 0x444U)
+		|| IsDigit(code);
+}
+
+// (?<![\w\$\-\_%=\.])
+inline bool IsDomainStartBlocker(uint code) {
+	return IsWord(code)
+		|| (code == '$')
+		|| (code == '-')
+		|| (code == '%')
+		|| (code == '=')
+		|| (code == '.');
+}
+
+// See ExpressionSeparators() in text_entity.cpp.
+inline bool IsSeparator(ushort code, bool withSlash) {
+	switch (code) {
+	case '.': case ',': case ':': case ';': case '<': case '>': case '|':
+	case '\'': case '"': case '[': case ']': case '{': case '}': case '~':
+	case '!': case '?': case '%': case '^': case '(': case ')': case '-':
+	case '+': case '=': case 0x10: case '`': case '*':
+	case 0xABU: case 0xBBU: case 0x201CU: case 0x201DU: case 0x2018U:
+	case 0x2019U:
+		return true;
+	case '/':
+		return withSlash;
+	}
+	return IsSpace(code);
+}
+
+// (^|[separators])<symbol>, returns the position of <symbol> or -1.
+int MatchTagStart(
+		const QChar *start,
+		const QChar *end,
+		const QChar *ch,
+		ushort symbol,
+		bool withSlash) {
+	if (ch == start && ch->unicode() == symbol) {
+		return 0;
+	} else if (ch + 1 < end
+		&& (ch + 1)->unicode() == symbol
+		&& IsSeparator(ch->unicode(), withSlash)) {
+		return (ch + 1 - start);
+	}
+	return -1;
+}
+
+// ([\W]|$) right after a maximal run of [A-Za-z_0-9] or \w characters.
+bool MatchTagEnd(const QChar *ch, const QChar *end) {
+	return (ch == end) || !IsWord(ReadForward(ch, end).code);
+}
+
+DomainMatch MatchDomainAt(
+		const QChar *start,
+		const QChar *end,
+		const QChar *ch,
+		bool explicitProtocol) {
+	auto result = DomainMatch();
+	auto domain = ch;
+	auto protocol = ch;
+	while (protocol < end && IsAsciiLetter(protocol->unicode())) {
+		++protocol;
+	}
+	if (protocol > ch
+		&& end - protocol > 2
+		&& protocol->unicode() == ':'
+		&& (protocol + 1)->unicode() == '/'
+		&& (protocol + 2)->unicode() == '/') {
+		result.protocolStart = (ch - start);
+		result.protocolLength = (protocol - ch);
+		domain = protocol + 3;
+	} else if (explicitProtocol) {
+		return DomainMatch();
+	}
+
+	// Labels can't contain '.', so the greedy (?:label\.){min,10} leaves
+	// only the labels count for the regex engine to backtrack over.
+	const QChar *labels[kMaxDomainLabels + 1] = { domain };
+	auto count = 0;
+	for (auto label = domain; count != kMaxDomainLabels;) {
+		auto till = label;
+		while (till < end && IsDomainLabel(till->unicode())) {
+			++till;
+		}
+		if (till == label || till == end || till->unicode() != '.') {
+			break;
+		}
+		label = labels[++count] = till + 1;
+	}
+	const auto minLabels = explicitProtocol ? 0 : 1;
+	for (auto index = count; index >= minLabels; --index) {
+		auto top = labels[index];
+		auto length = 0;
+		while (top < end && length != kMaxTopDomainLength) {
+			const auto read = ReadForward(top, end);
+			if (!IsTopDomain(read.code)) {
+				break;
+			}
+			top += read.length;
+			++length;
+		}
+		if (length < kMinTopDomainLength) {
+			continue;
+		}
+		result.start = (ch - start);
+		result.topDomainStart = (labels[index] - start);
+		result.topDomainLength = (top - labels[index]);
+
+		// (\:\d+)?
+		auto port = top;
+		if (port < end && port->unicode() == ':') {
+			++port;
+			while (port < end) {
+				const auto read = ReadForward(port, end);
+				if (!IsDigit(read.code)) {
+					break;
+				}
+				port += read.length;
+			}
+			if (port > top + 1) {
+				top = port;
+			}
+		}
+		result.end = (top - start);
+		return result;
+	}
+	// Without the protocol the first label would end with ':' instead of
+	// '.', so the regex engine backtracking there fails as well.
+	return DomainMatch();
+}
+
+DomainMatch FindDomain(
+		const QString &text,
+		int from,
+		bool explicitProtocol) {
+	const auto start = text.constData();
+	const auto end = start + text.size();
+	for (auto ch = start + from; ch < end;) {
+		if (!IsDomainLabel(ch->unicode())) {
+			++ch;
+			continue;
+		}
+		if (ch == start || !IsDomainStartBlocker(ReadBackward(start, ch).code)) {
+			const auto result = MatchDomainAt(start, end, ch, explicitProtocol);
+			if (result.valid()) {
+				return result;
+			}
+		}
+
+		// All label characters block the domain start after them.
+		while (ch < end && IsDomainLabel(ch->unicode())) {
+			++ch;
+		}
+	}
+	return DomainMatch();
+}
+
+// (^|[separators])<symbol>\w{2,64}([\W]|$)
+TagMatch MatchHashtagAt(const QChar *start, const QChar *end, const QChar *ch) {
+	const auto symbol = MatchTagStart(start, end, ch, '#', true);
+	if (symbol < 0) {
+		return TagMatch();
+	}
+	auto till = start + symbol + 1;
+	auto length = 0;
+	while (till < end) {
+		const auto read = ReadForward(till, end);
+		if (!IsWord(read.code)) {
+			break;
+		}
+		till += read.length;
+		++length;
+	}
+	if (length < kMinHashtagLength || length > kMaxHashtagLength) {
+		return TagMatch();
+	}
+	auto result = TagMatch();
+	result.matchStart = (ch - start);
+	result.start = symbol;
+	result.end = (till - start);
+	return result;
+}
+
+// (^|[separators])@[A-Za-z_0-9]{1,32}([\W]|$)
+TagMatch MatchMentionAt(const QChar *start, const QChar *end, const QChar *ch) {
+	const auto symbol = MatchTagStart(start, end, ch, '@', true);
+	if (symbol < 0) {
+		return TagMatch();
+	}
+	const auto from = start + symbol + 1;
+	auto till = from;
+	while (till < end && IsAsciiWord(till->unicode())) {
+		++till;
+	}
+	if (till == from
+		|| till - from > kMaxMentionLength
+		|| !MatchTagEnd(till, end)) {
+		return TagMatch();
+	}
+	auto result = TagMatch();
+	result.matchStart = (ch - start);
+	result.start = symbol;
+	result.end = (till - start);
+	return result;
+}
+
+// (^|[separators])/[A-Za-z_0-9]{1,64}(@[A-Za-z_0-9]{5,32})?([\W]|$)
+TagMatch MatchBotCommandAt(
+		const QChar *start,
+		const QChar *end,
+		const QChar *ch) {
+	const auto symbol = MatchTagStart(start, end, ch, '/', false);
+	if (symbol < 0) {
+		return TagMatch();
+	}
+	const auto from = start + symbol + 1;
+	auto till = from;
+	while (till < end && IsAsciiWord(till->unicode())) {
+		++till;
+	}
+	if (till == from || till - from > kMaxBotCommandLength) {
+		return TagMatch();
+	}
+	if (till < end && till->unicode() == '@') {
+		auto username = till + 1;
+		while (username < end && IsAsciiWord(username->unicode())) {
+			++username;
+		}
+		const auto length = (username - till - 1);
+		if (length >= kMinBotUsernameLength
+			&& length <= kMaxBotUsernameLength
+			&& MatchTagEnd(username, end)) {
+			till = username;
+		}
+
+		// Otherwise '@' is the trailing non-word character.
+	} else if (!MatchTagEnd(till, end)) {
+		return TagMatch();
+	}
+	auto result = TagMatch();
+	result.matchStart = (ch - start);
+	result.start = symbol;
+	result.end = (till - start);
+	return result;
+}
+
+template <typename Matcher>
+TagMatch FindTag(const QString &text, int from, Matcher matcher) {
+	const auto start = text.constData();
+	const auto end = start + text.size();
+	for (auto ch = start + from; ch < end; ++ch) {
+		const auto result = matcher(start, end, ch);
+		if (result.valid()) {
+			return result;
+		}
+	}
+	return TagMatch();
+}
+
+inline int MatchStart(const DomainMatch &match) {
+	return match.start;
+}
+
+inline int MatchStart(const TagMatch &match) {
+	return match.matchStart;
+}
+
+} // namespace
+
+DomainMatch FindDomain(const QString &text, int from) {
+	return FindDomain(text, from, false);
+}
+
+DomainMatch FindDomainExplicit(const QString &text, int from) {
+	return FindDomain(text, from, true);
+}
+
+TagMatch FindHashtag(const QString &text, int from) {
+	return FindTag(text, from, MatchHashtagAt);
+}
+
+TagMatch FindMention(const QString &text, int from) {
+	return FindTag(text, from, MatchMentionAt);
+}
+
+TagMatch FindBotCommand(const QString &text, int from) {
+	return FindTag(text, from, MatchBotCommandAt);
+}
+
+int FindMailNameStart(const QString &text, int from, int till) {
+	// [a-zA-Z\-_\.0-9]{1,256}$
+	const auto start = text.constData();
+	auto ch = start + till;
+	while (ch > start + from && till - (ch - start) < kMaxMailNameLength) {
+		const auto code = (ch - 1)->unicode();
+		if (!IsAsciiWord(code) && code != '-' && code != '.') {
+			break;
+		}
+		--ch;
+	}
+	return (ch - start < till) ? (ch - start) : -1;
+}
+
+template <typename Match, typename Finder>
+const Match &EntityScanner::find(
+		Cached<Match> &cached,
+		int from,
+		Finder finder) {
+	// The leftmost match from 'cached.from' is also the leftmost one
+	// from any position between 'cached.from' and its start.
+	const auto reuse = (cached.from >= 0)
+		&& (cached.from <= from)
+		&& (!cached.match.valid() || MatchStart(cached.match) >= from);
+	if (!reuse) {
+		cached.from = from;
+		cached.match = finder(_text, from);
+	}
+	return cached.match;
+}
+
+const DomainMatch &EntityScanner::domain(int from) {
+	return find(_domain, from, [](const QString &text, int from) {
+		return FindDomain(text, from);
+	});
+}
+
+const DomainMatch &EntityScanner::domainExplicit(int from) {
+	return find(_domainExplicit, from, [](const QString &text, int from) {
+		return FindDomainExplicit(text, from);
+	});
+}
+
+const TagMatch &EntityScanner::hashtag(int from) {
+	return find(_hashtag, from, [](const QString &text, int from) {
+		return FindHashtag(text, from);
+	});
+}
+
+const TagMatch &EntityScanner::mention(int from) {
+	return find(_mention, from, [](const QString &text, int from) {
+		return FindMention(text, from);
+	});
+}
+
+const TagMatch &EntityScanner::botCommand(int from) {
+	return find(_botCommand, from, [](const QString &text, int from) {
+		return FindBotCommand(text, from);
+	});
+}
+
+} // namespace TextUtilities
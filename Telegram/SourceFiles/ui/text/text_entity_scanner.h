@@ -0,0 +1,89 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtCore/QString>
+
+namespace TextUtilities {
+
+// Hand-written matchers for the link-like entities found by ParseEntities.
+//
+// Each Find*() call returns the leftmost match starting at or after 'from',
+// exactly as QRegularExpression::match(text, from) would do for the
+// corresponding RegExp*() expression from text_entity.h, but without the
+// regex engine and without any allocations.
+//
+// Positions are in UTF-16 code units, counting rules are in code points.
+
+struct DomainMatch {
+	bool valid() const {
+		return (start >= 0);
+	}
+
+	int start = -1; // Including protocol.
+	int end = -1; // Including port.
+	int protocolStart = -1;
+	int protocolLength = 0;
+	int topDomainStart = -1;
+	int topDomainLength = 0;
+};
+
+struct TagMatch {
+	bool valid() const {
+		return (start >= 0);
+	}
+
+	int matchStart = -1; // Including the leading separator.
+	int start = -1; // Position of '#', '@' or '/'.
+	int end = -1; // Excluding the trailing separator.
+};
+
+DomainMatch FindDomain(const QString &text, int from);
+DomainMatch FindDomainExplicit(const QString &text, int from);
+TagMatch FindHashtag(const QString &text, int from);
+TagMatch FindMention(const QString &text, int from);
+TagMatch FindBotCommand(const QString &text, int from);
+
+// Start of the e-mail name ending right at 'till' or -1.
+int FindMailNameStart(const QString &text, int from, int till);
+
+// Keeps the last found match of each kind and reuses it while it still
+// starts at or after the requested position, so that a whole ParseEntities
+// call walks the text once per entity kind instead of rescanning it from
+// every found entity.
+class EntityScanner {
+public:
+	explicit EntityScanner(const QString &text) : _text(text) {
+	}
+
+	const DomainMatch &domain(int from);
+	const DomainMatch &domainExplicit(int from);
+	const TagMatch &hashtag(int from);
+	const TagMatch &mention(int from);
+	const TagMatch &botCommand(int from);
+
+private:
+	template <typename Match>
+	struct Cached {
+		int from = -1;
+		Match match;
+	};
+
+	template <typename Match, typename Finder>
+	const Match &find(Cached<Match> &cached, int from, Finder finder);
+
+	const QString &_text;
+	Cached<DomainMatch> _domain;
+	Cached<DomainMatch> _domainExplicit;
+	Cached<TagMatch> _hashtag;
+	Cached<TagMatch> _mention;
+	Cached<TagMatch> _botCommand;
+
+};
+
+} // namespace TextUtilities
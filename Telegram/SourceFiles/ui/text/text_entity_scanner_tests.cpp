@@ -0,0 +1,191 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "ui/text/text_entity_scanner.h"
+#include <QtCore/QRegularExpression>
+#include <random>
+
+using namespace TextUtilities;
+
+namespace {
+
+// Copies of the expressions from text_entity.cpp the scanner replaces.
+QString Separators(const QString &additional) {
+	const auto quotes = QString::fromUtf8("\xC2\xAB\xC2\xBB\xE2\x80\x9C\xE2\x80\x9D\xE2\x80\x98\xE2\x80\x99");
+	return QString("\\s\\.,:;<>|'\"\\[\\]\\{\\}\\~\\!\\?\\%\\^\\(\\)\\-\\+=\\x10") + quotes + additional;
+}
+
+QRegularExpression Create(const QString &expression) {
+	return QRegularExpression(expression, QRegularExpression::UseUnicodePropertiesOption);
+}
+
+const QRegularExpression &RegExpDomain() {
+	static const auto result = Create(QString::fromUtf8("(?<![\\w\\$\\-\\_%=\\.])(?:([a-zA-Z]+)://)?((?:[A-Za-z" "\xD0\x90-\xD0\xAF\xD0\x81" "\xD0\xB0-\xD1\x8F\xD1\x91" "0-9\\-\\_]+\\.){1,10}([A-Za-z" "\xD1\x80\xD1\x84" "\\-\\d]{2,22})(\\:\\d+)?)"));
+	return result;
+}
+
+const QRegularExpression &RegExpDomainExplicit() {
+	static const auto result = Create(QString::fromUtf8("(?<![\\w\\$\\-\\_%=\\.])(?:([a-zA-Z]+)://)((?:[A-Za-z" "\xD0\x90-\xD0\xAF\xD0\x81" "\xD0\xB0-\xD1\x8F\xD1\x91" "0-9\\-\\_]+\\.){0,10}([A-Za-z" "\xD1\x80\xD1\x84" "\\-\\d]{2,22})(\\:\\d+)?)"));
+	return result;
+}
+
+const QRegularExpression &RegExpHashtag() {
+	static const auto result = Create("(^|[" + Separators("`\\*/") + "])#[\\w]{2,64}([\\W]|$)");
+	return result;
+}
+
+const QRegularExpression &RegExpMention() {
+	static const auto result = Create("(^|[" + Separators("`\\*/") + "])@[A-Za-z_0-9]{1,32}([\\W]|$)");
+	return result;
+}
+
+const QRegularExpression &RegExpBotCommand() {
+	static const auto result = Create("(^|[" + Separators("`\\*") + "])/[A-Za-z_0-9]{1,64}(@[A-Za-z_0-9]{5,32})?([\\W]|$)");
+	return result;
+}
+
+// '$' matches before a trailing '\n' as well, so "name\n@mail.com" was
+// detected as an e-mail, the scanner requires the name right before '@'.
+const QRegularExpression &RegExpMailNameAtEnd() {
+	static const auto result = Create("[a-zA-Z\\-_\\.0-9]{1,256}\\z");
+	return result;
+}
+
+void CheckDomain(const DomainMatch &scanned, const QRegularExpressionMatch &m) {
+	REQUIRE(scanned.valid() == m.hasMatch());
+	if (!m.hasMatch()) {
+		return;
+	}
+	REQUIRE(scanned.start == m.capturedStart());
+	REQUIRE(scanned.end == m.capturedEnd());
+	REQUIRE(scanned.protocolLength == m.capturedLength(1));
+	if (m.capturedLength(1)) {
+		REQUIRE(scanned.protocolStart == m.capturedStart(1));
+	}
+	REQUIRE(scanned.topDomainStart == m.capturedStart(3));
+	REQUIRE(scanned.topDomainLength == m.capturedLength(3));
+}
+
+void CheckTag(const TagMatch &scanned, const QRegularExpressionMatch &m, int trailing) {
+	REQUIRE(scanned.valid() == m.hasMatch());
+	if (!m.hasMatch()) {
+		return;
+	}
+	REQUIRE(scanned.matchStart == m.capturedStart());
+	REQUIRE(scanned.start == m.capturedEnd(1));
+	REQUIRE(scanned.end == m.capturedStart(trailing));
+}
+
+QString RandomText(std::mt19937 &generator) {
+	static const auto alphabet = QString::fromUtf8(
+		"aZk09_-.:/@#$%=` *,!?()\n"
+		"\xD0\x90\xD1\x8F\xD1\x80\xD1\x84\xD1\x91" // Cyrillic
+		"\xD9\xA3" // Arabic-indic digit three
+		"\xC2\xAB\xE2\x80\x9D"); // Quotes
+	static const auto pieces = QStringList{
+		QString("http://"),
+		QString("https://"),
+		QString("tg://"),
+		QString(".com"),
+		QString("abcde"),
+		QString("@botname"),
+		QString::fromUtf8("\xF0\x9D\x90\x80"), // Mathematical bold A
+		QString::fromUtf8("\xF0\x9D\x9F\x8E"), // Mathematical bold zero
+	};
+	auto letter = std::uniform_int_distribution<int>(0, alphabet.size() - 1);
+	auto piece = std::uniform_int_distribution<int>(0, pieces.size() - 1);
+	auto length = std::uniform_int_distribution<int>(0, 40);
+	auto result = QString();
+	for (auto i = 0, count = length(generator); i != count; ++i) {
+		if (generator() % 4) {
+			result.append(alphabet[letter(generator)]);
+		} else {
+			result.append(pieces[piece(generator)]);
+		}
+	}
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("entity scanner finds simple entities", "[text_entity_scanner]") {
+	SECTION("domains") {
+		const auto text = QString("see https://telegram.org:443/path and a.b");
+		const auto domain = FindDomain(text, 0);
+		REQUIRE(domain.valid());
+		REQUIRE(text.mid(domain.start, domain.end - domain.start) == "https://telegram.org:443");
+		REQUIRE(text.mid(domain.protocolStart, domain.protocolLength) == "https");
+		REQUIRE(text.mid(domain.topDomainStart, domain.topDomainLength) == "org");
+		REQUIRE(!FindDomain(text, domain.end).valid());
+	}
+	SECTION("tags") {
+		const auto text = QString("#tag, @user /start@somebot!");
+		const auto hashtag = FindHashtag(text, 0);
+		REQUIRE(hashtag.start == 0);
+		REQUIRE(hashtag.end == 4);
+		const auto mention = FindMention(text, 0);
+		REQUIRE(mention.start == 6);
+		REQUIRE(mention.end == 11);
+		const auto command = FindBotCommand(text, 0);
+		REQUIRE(command.start == 12);
+		REQUIRE(command.end == text.size() - 1);
+	}
+	SECTION("mail names") {
+		const auto text = QString("mail: some.name@host.com");
+		REQUIRE(FindMailNameStart(text, 0, text.indexOf('@')) == 6);
+		REQUIRE(FindMailNameStart(text, 0, 5) == -1);
+	}
+}
+
+TEST_CASE("entity scanner matches the regular expressions", "[text_entity_scanner]") {
+	auto generator = std::mt19937(20180119);
+	for (auto i = 0; i != 20000; ++i) {
+		const auto text = RandomText(generator);
+		for (auto from = 0; from <= text.size(); ++from) {
+			if (from < text.size() && text[from].isLowSurrogate()) {
+				continue;
+			}
+			CheckDomain(
+				FindDomain(text, from),
+				RegExpDomain().match(text, from));
+			CheckDomain(
+				FindDomainExplicit(text, from),
+				RegExpDomainExplicit().match(text, from));
+			CheckTag(
+				FindHashtag(text, from),
+				RegExpHashtag().match(text, from),
+				2);
+			CheckTag(
+				FindMention(text, from),
+				RegExpMention().match(text, from),
+				2);
+			CheckTag(
+				FindBotCommand(text, from),
+				RegExpBotCommand().match(text, from),
+				3);
+
+			const auto mail = RegExpMailNameAtEnd().match(text.mid(0, from));
+			REQUIRE(FindMailNameStart(text, 0, from)
+				== (mail.hasMatch() ? mail.capturedStart() : -1));
+		}
+	}
+}
+
+TEST_CASE("entity scanner reuses matches while moving forward", "[text_entity_scanner]") {
+	auto generator = std::mt19937(20180120);
+	for (auto i = 0; i != 2000; ++i) {
+		const auto text = RandomText(generator);
+		auto scanner = EntityScanner(text);
+		for (auto from = 0; from <= text.size(); from += 1 + (generator() % 3)) {
+			CheckDomain(scanner.domain(from), RegExpDomain().match(text, from));
+			CheckTag(scanner.hashtag(from), RegExpHashtag().match(text, from), 2);
+			CheckTag(scanner.mention(from), RegExpMention().match(text, from), 2);
+		}
+	}
+}
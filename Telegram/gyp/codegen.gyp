@@ -151,6 +151,7 @@
       '<(src_loc)/codegen/emoji/options.h',
       '<(src_loc)/codegen/emoji/replaces.cpp',
       '<(src_loc)/codegen/emoji/replaces.h',
+      '<(src_loc)/ui/emoji_trie.h',
     ],
   }],
 }
@@ -60,6 +60,15 @@
       '<(src_loc)/base/flags.h',
       '<(src_loc)/base/flags_tests.cpp',
     ],
+  }, {
+    'target_name': 'tests_flat_hash_map',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/flat_hash_map.h',
+      '<(src_loc)/base/flat_hash_map_tests.cpp',
+    ],
   }, {
     'target_name': 'tests_flat_map',
     'includes': [
@@ -115,5 +124,15 @@
       '<(src_loc)/rpl/variable.h',
       '<(src_loc)/rpl/variable_tests.cpp',
     ],
+  }, {
+    'target_name': 'tests_text_entity_scanner',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/ui/text/text_entity_scanner.cpp',
+      '<(src_loc)/ui/text/text_entity_scanner.h',
+      '<(src_loc)/ui/text/text_entity_scanner_tests.cpp',
+    ],
   }],
 }